@@ -1,4 +1,6 @@
+#pragma once
 #include <iostream>
+#include <algorithm>
 #include <vector>
 #include <string>
 
@@ -227,6 +229,9 @@ public:
       --answer.size;
       answer.buffer.pop_back();
     }
+    if (answer.size == 1 && answer.buffer[0] == 0) {
+      answer.sign = 1;
+    }
     return *this = answer;
   }
 
@@ -313,7 +318,7 @@ BigInteger& BigInteger::operator/=(const BigInteger& other) {
     slice.buffer.insert(slice.buffer.begin(), buffer[i]);
     ++slice.size;
     size_t current = slice.size;
-    for (size_t i = current - 1; current >= 1; --i) {
+    for (size_t i = current - 1; i >= 1; --i) {
       if (slice.buffer[i] == 0) {
         --slice.size;
       } else {
@@ -346,6 +351,9 @@ BigInteger& BigInteger::operator/=(const BigInteger& other) {
       break;
     }
   }
+  if (answer.size == 1 && answer.buffer[0] == 0) {
+    answer.sign = 1;
+  }
   return *this = answer;
 } // Ğ¿Ğ¾Ñ Ğ¼Ğ¾Ñ Ñ ĞµÑ Ñ  ĞµÑ Ğµ
 
@@ -392,8 +400,6 @@ public:
 
   void shorten() {
     transform();
-    int s1 = numerator.get_sign();
-    int s2 = denominator.get_sign();
     BigInteger a = numerator;
     a *= a.get_sign();
     BigInteger b = denominator;
@@ -407,7 +413,6 @@ public:
     }
     numerator /= a + b;
     denominator /= a + b;
-    numerator *= s1 * s2;
     denominator *= denominator.get_sign();
   }
 
@@ -0,0 +1,221 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <random>
+#include "bigint.h"
+
+// Standalone benchmark for bigint.h:
+//   g++ -std=c++17 -O2 bigint_benchmark.cpp -o bigint_benchmark
+//   ./bigint_benchmark [--format=csv|json] [--max-limbs=N] [--budget-ms=M] [--min-time-ms=T]
+// Operand sizes are swept in limbs (one limb = 9 decimal digits) along a 1-2-5 grid.
+// An operation stops growing once a single call exceeds the budget, so quadratic
+// algorithms do not stall the whole run.
+
+static size_t allocation_count = 0;
+static size_t allocated_bytes = 0;
+
+// noinline keeps GCC from pairing the inlined malloc/free with new/delete
+// expressions in callers (-Wmismatched-new-delete).
+__attribute__((noinline)) void* operator new(size_t size) {
+  ++allocation_count;
+  allocated_bytes += size;
+  if (void* ptr = malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+struct Measurement {
+  string operation;
+  size_t limbs = 0;
+  size_t iterations = 0;
+  double ns_per_op = 0;
+  double limbs_per_second = 0;
+  double allocations_per_op = 0;
+  double bytes_per_op = 0;
+};
+
+struct BenchmarkOptions {
+  bool json = false;
+  size_t max_limbs = 1000000;
+  double budget_ms = 2000;
+  double min_time_ms = 50;
+};
+
+static volatile int64_t sink = 0;
+
+string random_digits(std::mt19937_64& generator, size_t limbs) {
+  string digits(limbs * 9, '0');
+  digits[0] = static_cast<char>('1' + generator() % 9);
+  for (size_t i = 1; i < digits.size(); ++i) {
+    digits[i] = static_cast<char>('0' + generator() % 10);
+  }
+  return digits;
+}
+
+Measurement measure(const string& operation, size_t limbs, const BenchmarkOptions& options,
+                    const std::function<void()>& body) {
+  using clock = std::chrono::steady_clock;
+  Measurement result;
+  result.operation = operation;
+  result.limbs = limbs;
+  size_t allocations_before = allocation_count;
+  size_t bytes_before = allocated_bytes;
+  clock::time_point start = clock::now();
+  double elapsed_ms = 0;
+  size_t batch = 1;
+  while (elapsed_ms < options.min_time_ms) {
+    for (size_t i = 0; i < batch; ++i) {
+      body();
+    }
+    result.iterations += batch;
+    elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    if (elapsed_ms > options.budget_ms) {
+      break;
+    }
+    batch *= 2;
+  }
+  double iterations = static_cast<double>(result.iterations);
+  result.ns_per_op = elapsed_ms * 1e6 / iterations;
+  result.limbs_per_second = static_cast<double>(limbs) * 1e9 / result.ns_per_op;
+  result.allocations_per_op = static_cast<double>(allocation_count - allocations_before) / iterations;
+  result.bytes_per_op = static_cast<double>(allocated_bytes - bytes_before) / iterations;
+  return result;
+}
+
+vector<size_t> limb_grid(size_t max_limbs) {
+  vector<size_t> grid;
+  for (size_t decade = 1; decade <= max_limbs; decade *= 10) {
+    for (size_t step: {1, 2, 5}) {
+      if (decade * step <= max_limbs) {
+        grid.push_back(decade * step);
+      }
+    }
+  }
+  return grid;
+}
+
+using Operation = std::function<std::function<void()>(std::mt19937_64&, size_t)>;
+
+vector<std::pair<string, Operation>> operations() {
+  vector<std::pair<string, Operation>> result;
+  result.emplace_back("add", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    BigInteger a(random_digits(gen, limbs));
+    BigInteger b(random_digits(gen, limbs));
+    return [a, b]() { sink += (a + b).get_sign(); };
+  });
+  result.emplace_back("mul", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    BigInteger a(random_digits(gen, limbs));
+    BigInteger b(random_digits(gen, limbs));
+    return [a, b]() { sink += (a * b).get_sign(); };
+  });
+  result.emplace_back("div", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    BigInteger a(random_digits(gen, 2 * limbs));
+    BigInteger b(random_digits(gen, limbs));
+    return [a, b]() { sink += (a / b).get_sign(); };
+  });
+  result.emplace_back("mod", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    BigInteger a(random_digits(gen, 2 * limbs));
+    BigInteger b(random_digits(gen, limbs));
+    return [a, b]() { sink += (a % b).get_sign(); };
+  });
+  result.emplace_back("to_string", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    BigInteger a(random_digits(gen, limbs));
+    return [a]() { sink += static_cast<int64_t>(a.toString().size()); };
+  });
+  result.emplace_back("parse", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    string digits = random_digits(gen, limbs);
+    return [digits]() { sink += BigInteger(digits).get_sign(); };
+  });
+  result.emplace_back("rational_shorten", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    BigInteger common(random_digits(gen, (limbs + 1) / 2));
+    BigInteger a = common * BigInteger(random_digits(gen, limbs / 2 + 1));
+    BigInteger b = common * BigInteger(random_digits(gen, limbs / 2 + 1));
+    return [a, b]() {
+      Rational rational(a, b);
+      rational.shorten();
+      sink += rational < 0;
+    };
+  });
+  result.emplace_back("rational_as_decimal", [](std::mt19937_64& gen, size_t limbs) -> std::function<void()> {
+    Rational rational(BigInteger(random_digits(gen, limbs)), BigInteger(random_digits(gen, limbs)));
+    size_t precision = 9 * limbs;
+    return [rational, precision]() { sink += static_cast<int64_t>(rational.asDecimal(precision).size()); };
+  });
+  return result;
+}
+
+void print_csv(const vector<Measurement>& measurements) {
+  std::cout << "operation,limbs,iterations,ns_per_op,limbs_per_s,allocs_per_op,bytes_per_op\n";
+  for (const Measurement& m: measurements) {
+    std::cout << m.operation << ',' << m.limbs << ',' << m.iterations << ',' << m.ns_per_op << ','
+              << m.limbs_per_second << ',' << m.allocations_per_op << ',' << m.bytes_per_op << '\n';
+  }
+}
+
+void print_json(const vector<Measurement>& measurements) {
+  std::cout << "[\n";
+  for (size_t i = 0; i < measurements.size(); ++i) {
+    const Measurement& m = measurements[i];
+    std::cout << "  {\"operation\": \"" << m.operation << "\", \"limbs\": " << m.limbs
+              << ", \"iterations\": " << m.iterations << ", \"ns_per_op\": " << m.ns_per_op
+              << ", \"limbs_per_s\": " << m.limbs_per_second << ", \"allocs_per_op\": " << m.allocations_per_op
+              << ", \"bytes_per_op\": " << m.bytes_per_op << '}' << (i + 1 < measurements.size() ? "," : "") << '\n';
+  }
+  std::cout << "]\n";
+}
+
+BenchmarkOptions parse_options(int argc, char** argv) {
+  BenchmarkOptions options;
+  for (int i = 1; i < argc; ++i) {
+    string argument = argv[i];
+    if (argument == "--format=json") {
+      options.json = true;
+    } else if (argument == "--format=csv") {
+      options.json = false;
+    } else if (argument.rfind("--max-limbs=", 0) == 0) {
+      options.max_limbs = std::stoull(argument.substr(strlen("--max-limbs=")));
+    } else if (argument.rfind("--budget-ms=", 0) == 0) {
+      options.budget_ms = std::stod(argument.substr(strlen("--budget-ms=")));
+    } else if (argument.rfind("--min-time-ms=", 0) == 0) {
+      options.min_time_ms = std::stod(argument.substr(strlen("--min-time-ms=")));
+    } else {
+      std::cerr << "unknown argument: " << argument << '\n';
+      exit(2);
+    }
+  }
+  return options;
+}
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options = parse_options(argc, argv);
+  std::mt19937_64 generator(20211);
+  vector<Measurement> measurements;
+  for (auto& [name, operation]: operations()) {
+    for (size_t limbs: limb_grid(options.max_limbs)) {
+      std::function<void()> body = operation(generator, limbs);
+      Measurement m = measure(name, limbs, options, body);
+      measurements.push_back(m);
+      std::cerr << name << ' ' << limbs << " limbs: " << m.ns_per_op << " ns/op\n";
+      if (m.ns_per_op > options.budget_ms * 1e6) {
+        break;
+      }
+    }
+  }
+  if (options.json) {
+    print_json(measurements);
+  } else {
+    print_csv(measurements);
+  }
+  return 0;
+}
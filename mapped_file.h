@@ -0,0 +1,118 @@
+#pragma once
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "string.h"
+
+// Read-only view of a whole local file through mmap. Pages are loaded by the kernel
+// on first touch, so opening is O(1) and nothing is copied onto the heap.
+// Views returned by view()/substr() are valid while the MappedFile is alive.
+class MappedFile {
+private:
+  const char* data = nullptr;
+  size_t size = 0;
+
+  void unmap() {
+    if (data != nullptr) {
+      munmap(const_cast<char*>(data), size);
+      data = nullptr;
+      size = 0;
+    }
+  }
+
+public:
+  MappedFile() = default;
+
+  explicit MappedFile(const char* path) {
+    int descriptor = open(path, O_RDONLY | O_CLOEXEC);
+    if (descriptor == -1) {
+      throw std::system_error(errno, std::generic_category(), std::string("open ") + path);
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) == -1) {
+      int error = errno;
+      close(descriptor);
+      throw std::system_error(error, std::generic_category(), std::string("fstat ") + path);
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    if (length != 0) {
+      void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      if (mapping == MAP_FAILED) {
+        int error = errno;
+        close(descriptor);
+        throw std::system_error(error, std::generic_category(), std::string("mmap ") + path);
+      }
+      madvise(mapping, length, MADV_SEQUENTIAL);
+      data = static_cast<const char*>(mapping);
+      size = length;
+    }
+    close(descriptor);
+  }
+
+  explicit MappedFile(const String& path) : MappedFile(path.c_str()) {}
+
+  MappedFile(const MappedFile&) = delete;
+
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept : data(other.data), size(other.size) {
+    other.data = nullptr;
+    other.size = 0;
+  }
+
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      std::swap(data, other.data);
+      std::swap(size, other.size);
+    }
+    return *this;
+  }
+
+  size_t length() const {
+    return size;
+  }
+
+  bool empty() const {
+    return size == 0;
+  }
+
+  char operator[](size_t index) const {
+    return data[index];
+  }
+
+  StringView view() const {
+    return size == 0 ? StringView() : StringView(data, size);
+  }
+
+  operator StringView() const {
+    return view();
+  }
+
+  size_t find(StringView substring, size_t begin = 0) const {
+    return view().find(substring, begin);
+  }
+
+  size_t rfind(StringView substring) const {
+    return view().rfind(substring);
+  }
+
+  StringView substr(size_t start, size_t count) const {
+    return view().substr(start, count);
+  }
+
+  // Hint that the next accesses jump around (e.g. rfind from the end of the file).
+  void advise_random() const {
+    if (size != 0) {
+      madvise(const_cast<char*>(data), size, MADV_RANDOM);
+    }
+  }
+
+  ~MappedFile() {
+    unmap();
+  }
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include <stdexcept>
+#include <thread>
+#include "bigint.h"
+
+// Exact linear algebra over BigInteger. Elimination is fraction-free (Bareiss):
+// every intermediate entry is a minor of the source matrix, so no GCD is taken
+// until the final Rational answers are built.
+// Passing threads > 1 splits each elimination step by rows (link with -pthread).
+class BigMatrix {
+private:
+  size_t rows_ = 0;
+  size_t columns_ = 0;
+  vector<vector<BigInteger>> data_;
+
+  static const size_t kParallel_min_rows_ = 32;
+
+  struct Echelon {
+    vector<vector<BigInteger>> data;
+    vector<size_t> pivot_columns;
+    int sign = 1;
+  };
+
+  template<typename Function>
+  static void for_rows(size_t begin, size_t end, size_t threads, const Function& function) {
+    if (threads <= 1 || end - begin < kParallel_min_rows_) {
+      for (size_t i = begin; i < end; ++i) {
+        function(i);
+      }
+      return;
+    }
+    threads = std::min(threads, end - begin);
+    vector<std::thread> workers;
+    size_t chunk = (end - begin + threads - 1) / threads;
+    for (size_t first = begin; first < end; first += chunk) {
+      size_t last = std::min(end, first + chunk);
+      workers.emplace_back([first, last, &function]() {
+        for (size_t i = first; i < last; ++i) {
+          function(i);
+        }
+      });
+    }
+    for (std::thread& worker: workers) {
+      worker.join();
+    }
+  }
+
+  // Brings the first `columns` columns of `data` to row echelon form in place.
+  static Echelon eliminate(vector<vector<BigInteger>> data, size_t columns, size_t threads) {
+    Echelon echelon;
+    size_t rows = data.size();
+    size_t width = rows == 0 ? 0 : data[0].size();
+    BigInteger previous = 1;
+    size_t row = 0;
+    for (size_t column = 0; column < columns && row < rows; ++column) {
+      size_t pivot = row;
+      while (pivot < rows && data[pivot][column] == 0) {
+        ++pivot;
+      }
+      if (pivot == rows) {
+        continue;
+      }
+      if (pivot != row) {
+        std::swap(data[pivot], data[row]);
+        echelon.sign = -echelon.sign;
+      }
+      const vector<BigInteger>& pivot_row = data[row];
+      for_rows(row + 1, rows, threads, [&](size_t i) {
+        vector<BigInteger>& current = data[i];
+        for (size_t j = column + 1; j < width; ++j) {
+          current[j] = (pivot_row[column] * current[j] - current[column] * pivot_row[j]) / previous;
+        }
+        current[column] = 0;
+      });
+      previous = pivot_row[column];
+      echelon.pivot_columns.push_back(column);
+      ++row;
+    }
+    echelon.data = std::move(data);
+    return echelon;
+  }
+
+public:
+  BigMatrix() = default;
+
+  BigMatrix(size_t rows, size_t columns) : rows_(rows), columns_(columns),
+                                           data_(rows, vector<BigInteger>(columns, 0)) {}
+
+  BigMatrix(const vector<vector<BigInteger>>& data) : rows_(data.size()),
+                                                      columns_(data.empty() ? 0 : data[0].size()), data_(data) {
+    for (const vector<BigInteger>& row: data_) {
+      if (row.size() != columns_) {
+        throw std::invalid_argument("rows of a matrix must have equal length");
+      }
+    }
+  }
+
+  size_t rows() const {
+    return rows_;
+  }
+
+  size_t columns() const {
+    return columns_;
+  }
+
+  BigInteger& operator()(size_t row, size_t column) {
+    return data_[row][column];
+  }
+
+  const BigInteger& operator()(size_t row, size_t column) const {
+    return data_[row][column];
+  }
+
+  BigInteger determinant(size_t threads = 1) const {
+    if (rows_ != columns_) {
+      throw std::invalid_argument("determinant of a non-square matrix");
+    }
+    if (rows_ == 0) {
+      return 1;
+    }
+    Echelon echelon = eliminate(data_, columns_, threads);
+    if (echelon.pivot_columns.size() < rows_) {
+      return 0;
+    }
+    BigInteger answer = echelon.data[rows_ - 1][columns_ - 1];
+    if (echelon.sign == -1) {
+      return -answer;
+    }
+    return answer;
+  }
+
+  size_t rank(size_t threads = 1) const {
+    return eliminate(data_, columns_, threads).pivot_columns.size();
+  }
+
+  // Solves A x = rhs for a square non-singular A. With D = ±det(A) every D * x_i
+  // is an integer (Cramer's rule), so back substitution stays fraction-free too.
+  vector<Rational> solve(const vector<BigInteger>& rhs, size_t threads = 1) const {
+    if (rows_ != columns_ || rhs.size() != rows_) {
+      throw std::invalid_argument("solve expects a square matrix and a matching right-hand side");
+    }
+    size_t n = rows_;
+    if (n == 0) {
+      return {};
+    }
+    vector<vector<BigInteger>> augmented = data_;
+    for (size_t i = 0; i < n; ++i) {
+      augmented[i].push_back(rhs[i]);
+    }
+    Echelon echelon = eliminate(std::move(augmented), n, threads);
+    if (echelon.pivot_columns.size() < n) {
+      throw std::domain_error("matrix is singular");
+    }
+    vector<vector<BigInteger>>& m = echelon.data;
+    const BigInteger& d = m[n - 1][n - 1];
+    vector<BigInteger> scaled(n);
+    for (size_t i = n; i >= 1; --i) {
+      size_t row = i - 1;
+      BigInteger sum = d * m[row][n];
+      for (size_t j = row + 1; j < n; ++j) {
+        sum -= m[row][j] * scaled[j];
+      }
+      scaled[row] = sum / m[row][row];
+    }
+    vector<Rational> answer;
+    answer.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      answer.emplace_back(scaled[i], d);
+      answer.back().shorten();
+    }
+    return answer;
+  }
+};
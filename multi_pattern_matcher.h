@@ -0,0 +1,162 @@
+#pragma once
+#include <cstdint>
+#include <queue>
+#include <vector>
+#include "string.h"
+
+struct PatternMatch {
+  size_t pattern;
+  size_t offset;
+};
+
+// Aho-Corasick automaton over a fixed set of patterns. One pass over the text reports
+// every (pattern, offset) occurrence, overlapping ones included.
+// Bytes are first mapped to dense classes (only bytes that occur in some pattern get
+// their own class), so the complete transition table is one flat array of
+// states x classes entries instead of states x 256. Empty patterns are ignored.
+class MultiPatternMatcher {
+private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  uint8_t byte_class[256] = {};
+  size_t classes = 1;
+  std::vector<uint32_t> transitions;
+  std::vector<uint32_t> output_link;
+  std::vector<uint32_t> output_begin;
+  std::vector<uint32_t> outputs;
+  std::vector<size_t> pattern_lengths;
+
+  uint32_t& transition(uint32_t state, size_t byte_class_id) {
+    return transitions[state * classes + byte_class_id];
+  }
+
+  void build(const std::vector<StringView>& patterns) {
+    size_t distinct = 0;
+    for (StringView pattern: patterns) {
+      for (char c: pattern) {
+        uint8_t& id = byte_class[static_cast<unsigned char>(c)];
+        if (id == 0) {
+          id = static_cast<uint8_t>(++distinct);
+        }
+      }
+    }
+    if (distinct > 255) {
+      // Every byte value is used: give byte 255 the shared class 0 instead.
+      std::fill(byte_class, byte_class + 256, 0);
+      for (size_t b = 0; b < 255; ++b) {
+        byte_class[b] = static_cast<uint8_t>(b + 1);
+      }
+      distinct = 255;
+    }
+    classes = distinct + 1;
+
+    std::vector<std::vector<uint32_t>> own_patterns(1);
+    transitions.assign(classes, kNone);
+    for (size_t index = 0; index < patterns.size(); ++index) {
+      if (patterns[index].empty()) {
+        continue;
+      }
+      uint32_t state = 0;
+      for (char c: patterns[index]) {
+        uint32_t& next = transition(state, byte_class[static_cast<unsigned char>(c)]);
+        if (next == kNone) {
+          next = static_cast<uint32_t>(own_patterns.size());
+          own_patterns.emplace_back();
+          transitions.resize(transitions.size() + classes, kNone);
+        }
+        state = transition(state, byte_class[static_cast<unsigned char>(c)]);
+      }
+      own_patterns[state].push_back(static_cast<uint32_t>(index));
+    }
+    size_t states = own_patterns.size();
+
+    std::vector<uint32_t> failure(states, 0);
+    output_link.assign(states, kNone);
+    std::queue<uint32_t> queue;
+    for (size_t c = 0; c < classes; ++c) {
+      uint32_t& child = transition(0, c);
+      if (child == kNone) {
+        child = 0;
+      } else {
+        queue.push(child);
+      }
+    }
+    while (!queue.empty()) {
+      uint32_t state = queue.front();
+      queue.pop();
+      for (size_t c = 0; c < classes; ++c) {
+        uint32_t child = transition(state, c);
+        uint32_t fallback = transition(failure[state], c);
+        if (child == kNone) {
+          transition(state, c) = fallback;
+          continue;
+        }
+        failure[child] = fallback;
+        output_link[child] = own_patterns[fallback].empty() ? output_link[fallback] : fallback;
+        queue.push(child);
+      }
+    }
+
+    output_begin.assign(states + 1, 0);
+    for (size_t state = 0; state < states; ++state) {
+      output_begin[state + 1] = output_begin[state] + static_cast<uint32_t>(own_patterns[state].size());
+      outputs.insert(outputs.end(), own_patterns[state].begin(), own_patterns[state].end());
+    }
+    pattern_lengths.reserve(patterns.size());
+    for (StringView pattern: patterns) {
+      pattern_lengths.push_back(pattern.length());
+    }
+  }
+
+public:
+  explicit MultiPatternMatcher(const std::vector<StringView>& patterns) {
+    build(patterns);
+  }
+
+  explicit MultiPatternMatcher(const std::vector<String>& patterns) {
+    build(std::vector<StringView>(patterns.begin(), patterns.end()));
+  }
+
+  size_t pattern_count() const {
+    return pattern_lengths.size();
+  }
+
+  size_t state_count() const {
+    return output_link.size();
+  }
+
+  // Calls on_match(pattern_index, offset) for every occurrence, ordered by end position.
+  template<typename Callback>
+  void scan(StringView text, Callback&& on_match) const {
+    uint32_t state = 0;
+    for (size_t i = 0; i < text.length(); ++i) {
+      state = transitions[state * classes + byte_class[static_cast<unsigned char>(text[i])]];
+      uint32_t terminal = output_begin[state] == output_begin[state + 1] ? output_link[state] : state;
+      while (terminal != kNone) {
+        for (uint32_t k = output_begin[terminal]; k < output_begin[terminal + 1]; ++k) {
+          on_match(outputs[k], i + 1 - pattern_lengths[outputs[k]]);
+        }
+        terminal = output_link[terminal];
+      }
+    }
+  }
+
+  std::vector<PatternMatch> find_all(StringView text) const {
+    std::vector<PatternMatch> matches;
+    scan(text, [&matches](size_t pattern, size_t offset) {
+      matches.push_back({pattern, offset});
+    });
+    return matches;
+  }
+
+  bool contains_any(StringView text) const {
+    uint32_t state = 0;
+    for (size_t i = 0; i < text.length(); ++i) {
+      state = transitions[state * classes + byte_class[static_cast<unsigned char>(text[i])]];
+      if (output_begin[state] != output_begin[state + 1] || output_link[state] != kNone) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "string.h"
+
+// Multi-threaded substring search for very large texts. The text is cut into chunks of
+// candidate start positions; each chunk is searched over its range plus pattern.length() - 1
+// bytes of overlap, so a match is found exactly once, by the chunk owning its start.
+// Workers take chunks in order from a shared counter (link with -pthread).
+class ParallelSearch {
+private:
+  static constexpr size_t kChunk_size = 1 << 20;
+
+  template<typename Function>
+  static void run(size_t chunks, size_t threads, const Function& function) {
+    threads = std::max<size_t>(1, std::min(threads, chunks));
+    std::atomic<size_t> next_chunk(0);
+    auto worker = [&]() {
+      for (size_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+        function(chunk);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+      workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread: workers) {
+      thread.join();
+    }
+  }
+
+public:
+  // hardware_concurrency() may report 0 when unknown; never go below one thread.
+  static size_t default_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Leftmost occurrence, or text.length() if there is none.
+  static size_t find(StringView text, StringView pattern, size_t threads = default_threads()) {
+    if (pattern.length() > text.length()) {
+      return text.length();
+    }
+    size_t starts = text.length() - pattern.length() + 1;
+    if (threads <= 1 || starts <= kChunk_size) {
+      return text.find(pattern);
+    }
+    size_t chunks = (starts + kChunk_size - 1) / kChunk_size;
+    std::atomic<size_t> best(text.length());
+    run(chunks, threads, [&](size_t chunk) {
+      size_t begin = chunk * kChunk_size;
+      if (begin >= best.load(std::memory_order_relaxed)) {
+        return;
+      }
+      size_t count = std::min(kChunk_size, starts - begin);
+      StringView window = text.substr(begin, count + pattern.length() - 1);
+      size_t found = window.find(pattern);
+      if (found == window.length()) {
+        return;
+      }
+      size_t position = begin + found;
+      size_t current = best.load(std::memory_order_relaxed);
+      while (position < current && !best.compare_exchange_weak(current, position)) {
+      }
+    });
+    return best.load();
+  }
+
+  // Number of positions where pattern occurs; overlapping occurrences all count.
+  static size_t count(StringView text, StringView pattern, size_t threads = default_threads()) {
+    if (pattern.length() > text.length()) {
+      return 0;
+    }
+    size_t starts = text.length() - pattern.length() + 1;
+    if (pattern.empty()) {
+      return starts;
+    }
+    size_t chunks = (starts + kChunk_size - 1) / kChunk_size;
+    std::vector<size_t> counts(chunks, 0);
+    auto count_chunk = [&](size_t chunk) {
+      size_t begin = chunk * kChunk_size;
+      StringView window = text.substr(begin, std::min(kChunk_size, starts - begin) + pattern.length() - 1);
+      // Counted locally: neighbouring slots of `counts` belong to other threads' chunks.
+      size_t hits = 0;
+      for (size_t found = window.find(pattern); found != window.length(); found = window.find(pattern, found + 1)) {
+        ++hits;
+      }
+      counts[chunk] = hits;
+    };
+    if (threads <= 1 || chunks == 1) {
+      for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        count_chunk(chunk);
+      }
+    } else {
+      run(chunks, threads, count_chunk);
+    }
+    size_t total = 0;
+    for (size_t partial: counts) {
+      total += partial;
+    }
+    return total;
+  }
+};
+
+size_t parallel_find(StringView text, StringView pattern, size_t threads = ParallelSearch::default_threads()) {
+  return ParallelSearch::find(text, pattern, threads);
+}
+
+size_t parallel_count(StringView text, StringView pattern, size_t threads = ParallelSearch::default_threads()) {
+  return ParallelSearch::count(text, pattern, threads);
+}
@@ -1,85 +1,458 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Counters collected by StackStorage::enable_stats(). Byte figures are what the
+// caller asked for, except arena_bytes, which is what the bump pointer consumed;
+// peak_arena_bytes is therefore the smallest N that would have served the run
+// without growing (up to differences in alignment padding).
+struct StackStorageStats {
+  static constexpr size_t kSize_buckets = 8 * sizeof(size_t) + 1;
+
+  size_t allocations = 0;
+  size_t reused = 0;              // allocations served from a free list
+  size_t deallocations = 0;
+  size_t live_bytes = 0;
+  size_t peak_live_bytes = 0;
+  size_t arena_bytes = 0;
+  size_t peak_arena_bytes = 0;
+  size_t padding_bytes = 0;       // lost to alignment in the bump pointer
+  size_t rounding_bytes = 0;      // lost to size-class round-up
+  size_t dead_bytes = 0;          // deallocated but too large to recycle
+  size_t heap_blocks = 0;
+  size_t heap_bytes = 0;
+  size_t size_counts[kSize_buckets] = {};  // [b]: allocations of size in (2^(b-1), 2^b]
+
+  static size_t bucket(size_t size) {
+    size_t b = 0;
+    while (b + 1 < kSize_buckets && (size_t(1) << b) < size) {
+      ++b;
+    }
+    return b;
+  }
+
+  void write_json(std::ostream& out) const {
+    out << "{\"allocations\": " << allocations << ", \"reused\": " << reused
+        << ", \"deallocations\": " << deallocations << ", \"live_bytes\": " << live_bytes
+        << ", \"peak_live_bytes\": " << peak_live_bytes << ", \"arena_bytes\": " << arena_bytes
+        << ", \"peak_arena_bytes\": " << peak_arena_bytes << ", \"padding_bytes\": " << padding_bytes
+        << ", \"rounding_bytes\": " << rounding_bytes << ", \"dead_bytes\": " << dead_bytes
+        << ", \"heap_blocks\": " << heap_blocks << ", \"heap_bytes\": " << heap_bytes
+        << ", \"size_counts\": {";
+    const char* separator = "";
+    for (size_t b = 0; b < kSize_buckets; ++b) {
+      if (size_counts[b] != 0) {
+        out << separator << "\"" << (b + 1 < kSize_buckets ? size_t(1) << b : ~size_t(0)) << "\": " << size_counts[b];
+        separator = ", ";
+      }
+    }
+    out << "}}";
+  }
+};
 
+// Monotonic arena: allocations bump through the inline pool_[N]. A fixed storage throws
+// std::bad_alloc once the pool is exhausted; a growable one chains heap blocks, each
+// at least twice the previous, and keeps bumping there. Everything is freed at once
+// when the storage is destroyed.
+// Small requests are rounded up to size classes; freed small blocks go onto per-class
+// intrusive free lists and are handed out again before the arena is bumped, so
+// same-sized churn (List nodes) runs in bounded memory. Larger frees are dropped.
 template <size_t N>
 class StackStorage {
 private:
+  struct alignas(std::max_align_t) Block {
+    Block* previous;
+    size_t capacity;
+
+    char* data() {
+      return reinterpret_cast<char*>(this + 1);
+    }
+  };
+
+  static const size_t kGranule = alignof(void*);
+  static const size_t kMax_pooled = 256;
+  static const size_t kSize_classes = kMax_pooled / kGranule;
+
+  void* free_lists_[kSize_classes] = {};
+  char* region_;
+  size_t region_size_;
   size_t top_;
+  Block* blocks_ = nullptr;
+  bool growable_;
+  std::unique_ptr<StackStorageStats> stats_;
   alignas(std::max_align_t) char pool_[N];
+
+  void* bump(size_t align, size_t size) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(region_) + top_;
+    size_t padding = (align - address % align) % align;
+    if (padding > region_size_ - top_ || size > region_size_ - top_ - padding) {
+      return nullptr;
+    }
+    top_ += padding + size;
+    if (stats_) {
+      stats_->padding_bytes += padding;
+      stats_->arena_bytes += padding + size;
+      stats_->peak_arena_bytes = std::max(stats_->peak_arena_bytes, stats_->arena_bytes);
+    }
+    return region_ + top_ - size;
+  }
+
+  void record_alloc(size_t requested, size_t rounded, bool reused) {
+    stats_->allocations += 1;
+    stats_->reused += reused ? 1 : 0;
+    stats_->rounding_bytes += reused ? 0 : rounded - requested;
+    stats_->live_bytes += requested;
+    stats_->peak_live_bytes = std::max(stats_->peak_live_bytes, stats_->live_bytes);
+    stats_->size_counts[StackStorageStats::bucket(requested)] += 1;
+  }
+
+  void grow(size_t at_least) {
+    size_t capacity = std::max(at_least, 2 * (blocks_ == nullptr ? std::max<size_t>(N, 1) : blocks_->capacity));
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + capacity));
+    block->previous = blocks_;
+    block->capacity = capacity;
+    if (stats_) {
+      stats_->heap_blocks += 1;
+      stats_->heap_bytes += capacity;
+    }
+    blocks_ = block;
+    region_ = block->data();
+    region_size_ = capacity;
+    top_ = 0;
+  }
+
 public:
-  StackStorage(): top_(0) {}
+  // Position of the bump pointer, as returned by mark().
+  class Marker {
+  private:
+    Block* blocks_;
+    size_t top_;
+    size_t live_bytes_;
+    size_t arena_bytes_;
+    friend class StackStorage;
+
+    Marker(Block* blocks, size_t top, size_t live_bytes, size_t arena_bytes)
+        : blocks_(blocks), top_(top), live_bytes_(live_bytes), arena_bytes_(arena_bytes) {}
+  };
+
+  StackStorage(): StackStorage(false) {}
+
+  explicit StackStorage(bool growable): region_(pool_), region_size_(N), top_(0), growable_(growable) {}
+
   StackStorage(const StackStorage&) = delete;
 
+  StackStorage& operator=(const StackStorage&) = delete;
+
+  // Starts collecting StackStorageStats from this point on; call it before the first
+  // allocation and before taking markers for the figures to cover the whole run.
+  void enable_stats() {
+    stats_.reset(new StackStorageStats());
+  }
+
+  // nullptr unless enable_stats() was called.
+  const StackStorageStats* stats() const {
+    return stats_.get();
+  }
+
+  void write_stats_json(std::ostream& out) const {
+    if (stats_) {
+      stats_->write_json(out);
+    } else {
+      out << "null";
+    }
+  }
+
   void* alloc(size_t align, size_t size) {
-    if (top_ % align) {
-      top_ += align - top_ % align;
+    size_t requested = size;
+    if (size != 0 && size <= kMax_pooled) {
+      size_t size_class = (size - 1) / kGranule;
+      void* head = free_lists_[size_class];
+      if (head != nullptr && reinterpret_cast<uintptr_t>(head) % align == 0) {
+        memcpy(&free_lists_[size_class], head, sizeof(void*));
+        if (stats_) {
+          record_alloc(requested, size, true);
+        }
+        return head;
+      }
+      size = (size_class + 1) * kGranule;
+    }
+    void* memory = bump(align, size);
+    if (memory == nullptr) {
+      if (!growable_) {
+        throw std::bad_alloc();
+      }
+      grow(size + align);
+      memory = bump(align, size);
+    }
+    if (stats_) {
+      record_alloc(requested, size, false);
+    }
+    return memory;
+  }
+
+  void dealloc(void* memory, size_t size) {
+    if (memory == nullptr) {
+      return;
+    }
+    if (stats_) {
+      stats_->deallocations += 1;
+      stats_->live_bytes -= std::min(size, stats_->live_bytes);
+      stats_->dead_bytes += size > kMax_pooled ? size : 0;
+    }
+    if (size == 0 || size > kMax_pooled) {
+      return;
+    }
+    size_t size_class = (size - 1) / kGranule;
+    memcpy(memory, &free_lists_[size_class], sizeof(void*));
+    free_lists_[size_class] = memory;
+  }
+
+  Marker mark() const {
+    return Marker(blocks_, top_, stats_ ? stats_->live_bytes : 0, stats_ ? stats_->arena_bytes : 0);
+  }
+
+  // Frees, in O(1) plus one step per heap block, everything allocated after `marker`.
+  // Markers must be released in LIFO order. Free lists are emptied, since they may
+  // reference released memory; blocks freed earlier stay unused until an outer release.
+  void release(const Marker& marker) {
+    while (blocks_ != marker.blocks_) {
+      Block* previous = blocks_->previous;
+      ::operator delete(blocks_);
+      blocks_ = previous;
+    }
+    region_ = blocks_ == nullptr ? pool_ : blocks_->data();
+    region_size_ = blocks_ == nullptr ? N : blocks_->capacity;
+    top_ = marker.top_;
+    std::fill(free_lists_, free_lists_ + kSize_classes, nullptr);
+    if (stats_) {
+      stats_->live_bytes = marker.live_bytes_;
+      stats_->arena_bytes = marker.arena_bytes_;
+    }
+  }
+
+  ~StackStorage() {
+    while (blocks_ != nullptr) {
+      Block* previous = blocks_->previous;
+      ::operator delete(blocks_);
+      blocks_ = previous;
     }
-    top_ += size;
-    return pool_ + top_ - size;
   }
 };
 
 
-template <typename T, size_t N>
+// Arena shared by several threads: each allocation is one compare-and-swap bump of top_.
+// Reservations are whole multiples of max_align_t, so every start is already aligned
+// for ordinary types; over-aligned requests reserve extra slack and round up inside it.
+// With a non-zero cache_chunk, small requests are served from a per-thread chunk taken
+// from the shared pool, so threads touch the shared counter once per chunk.
+// Memory is never reused; dealloc is a no-op and the storage is freed as a whole.
+template <size_t N>
+class ConcurrentStackStorage {
+private:
+  static constexpr size_t kAlign = alignof(std::max_align_t);
+
+  struct ThreadCache {
+    uint64_t owner = 0;
+    char* current = nullptr;
+    char* end = nullptr;
+  };
+
+  static uint64_t next_id() {
+    static std::atomic<uint64_t> id(1);
+    return id++;
+  }
+
+  // A few direct-mapped slots per thread, so a thread alternating between storages
+  // keeps a chunk in each. A storage that lands on an occupied slot evicts it, and the
+  // rest of the evicted chunk is never used (the memory is only lost, not corrupted).
+  static constexpr size_t kCache_slots = 4;
+
+  ThreadCache& thread_cache() const {
+    thread_local ThreadCache caches[kCache_slots];
+    return caches[id_ % kCache_slots];
+  }
+
+  static char* align_up(char* pointer, size_t align) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return pointer + (align - address % align) % align;
+  }
+
+  const uint64_t id_;
+  const size_t cache_chunk_;
+  std::atomic<size_t> top_;
+  alignas(std::max_align_t) char pool_[N];
+
+  // A failed request leaves top_ untouched, so smaller requests can still succeed.
+  char* reserve(size_t bytes) {
+    size_t start = top_.load(std::memory_order_relaxed);
+    do {
+      if (bytes > N - start) {
+        throw std::bad_alloc();
+      }
+    } while (!top_.compare_exchange_weak(start, start + bytes, std::memory_order_relaxed));
+    return pool_ + start;
+  }
+
+  // Takes up to cache_chunk_ bytes for a thread's chunk; near the end of the pool the
+  // chunk shrinks to whatever is left, as long as it still covers the current request.
+  char* reserve_chunk(size_t bytes, size_t& taken) {
+    size_t start = top_.load(std::memory_order_relaxed);
+    do {
+      taken = std::min(cache_chunk_, (N - start) / kAlign * kAlign);
+      if (taken < bytes) {
+        throw std::bad_alloc();
+      }
+    } while (!top_.compare_exchange_weak(start, start + taken, std::memory_order_relaxed));
+    return pool_ + start;
+  }
+
+  static size_t chunk_size(size_t cache_chunk) {
+    size_t rounded = (std::min(cache_chunk, N) + kAlign - 1) / kAlign * kAlign;
+    return std::min(rounded, N / kAlign * kAlign);
+  }
+
+public:
+  // cache_chunk is clamped to the pool size.
+  explicit ConcurrentStackStorage(size_t cache_chunk = 0)
+      : id_(next_id()), cache_chunk_(chunk_size(cache_chunk)), top_(0) {}
+
+  ConcurrentStackStorage(const ConcurrentStackStorage&) = delete;
+
+  ConcurrentStackStorage& operator=(const ConcurrentStackStorage&) = delete;
+
+  void* alloc(size_t align, size_t size) {
+    size_t rounded = (size + kAlign - 1) / kAlign * kAlign;
+    size_t bytes = align <= kAlign ? rounded : rounded + align - kAlign;
+    if (cache_chunk_ != 0 && bytes <= cache_chunk_ / 4) {
+      ThreadCache& cache = thread_cache();
+      if (cache.owner != id_ || static_cast<size_t>(cache.end - cache.current) < bytes) {
+        size_t taken = 0;
+        cache.current = reserve_chunk(bytes, taken);
+        cache.end = cache.current + taken;
+        cache.owner = id_;
+      }
+      char* memory = align_up(cache.current, align);
+      cache.current = memory + rounded;
+      return memory;
+    }
+    return align_up(reserve(bytes), align);
+  }
+
+  void dealloc(void*, size_t) {}
+
+  // Bytes handed out so far, including per-thread chunks and alignment slack.
+  size_t used() const {
+    return top_.load(std::memory_order_relaxed);
+  }
+};
+
+
+// Releases everything allocated from the storage during the scope's lifetime.
+template <size_t N>
+class ArenaScope {
+private:
+  StackStorage<N>& storage_;
+  typename StackStorage<N>::Marker marker_;
+public:
+  explicit ArenaScope(StackStorage<N>& storage): storage_(storage), marker_(storage.mark()) {}
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+  ~ArenaScope() {
+    storage_.release(marker_);
+  }
+};
+
+
+// Storage is any arena with alloc(align, size) and dealloc(pointer, size);
+// by default the single-threaded StackStorage<N>.
+template <typename T, size_t N, typename Storage = StackStorage<N>>
 class StackAllocator {
 private:
-  StackStorage<N>* storage_ = nullptr;
-  template<typename U, size_t Q>
+  Storage* storage_ = nullptr;
+  template<typename U, size_t Q, typename S>
   friend class StackAllocator;
 public:
 
   using value_type = T;
 
   StackAllocator() = default;
-  StackAllocator(const StackStorage<N>& other) : storage_(const_cast<StackStorage<N>*>(&other)) {}
-  StackAllocator(const StackAllocator& other): storage_(other.storage) {}
+  StackAllocator(const Storage& other) : storage_(const_cast<Storage*>(&other)) {}
+  StackAllocator(const StackAllocator& other): storage_(other.storage_) {}
 
   template<typename U>
-  StackAllocator(const StackAllocator<U, N>& other): storage_(other.storage) {}
+  StackAllocator(const StackAllocator<U, N, Storage>& other): storage_(other.storage_) {}
 
   T* allocate(size_t size) {
     return reinterpret_cast<T*>(storage_->alloc( alignof(T), sizeof(T) * size));
   }
 
-  void deallocate(T*, size_t) {}
+  void deallocate(T* pointer, size_t size) {
+    storage_->dealloc(pointer, sizeof(T) * size);
+  }
 
   template<typename U>
   struct rebind {
-    using other = StackAllocator<U, N>;
+    using other = StackAllocator<U, N, Storage>;
   };
 
   template<typename U>
-  StackAllocator& operator=(const StackAllocator<U, N>& other) {
-    storage_ = other.storage;
+  StackAllocator& operator=(const StackAllocator<U, N, Storage>& other) {
+    storage_ = other.storage_;
     return *this;
   }
 
   template<typename U>
-  bool operator==(const StackAllocator<U, N>&) {
-    return true;
+  bool operator==(const StackAllocator<U, N, Storage>& other) const {
+    return storage_ == other.storage_;
   }
 
   template<typename U>
-  bool operator!=(const StackAllocator<U, N>&) {
-    return false;
+  bool operator!=(const StackAllocator<U, N, Storage>& other) const {
+    return storage_ != other.storage_;
   }
 };
 
+template <typename T, size_t N>
+using ConcurrentStackAllocator = StackAllocator<T, N, ConcurrentStackStorage<N>>;
+
+// True for allocators whose deallocate accepts any piece of an earlier, larger
+// allocation: containers may then carve several nodes out of one request.
+template <typename Allocator>
+struct allows_partial_deallocation: std::false_type {};
+
+template <typename T, size_t N, typename Storage>
+struct allows_partial_deallocation<StackAllocator<T, N, Storage>>: std::true_type {};
+
 template <typename T, typename allocator = std::allocator<T>>
 class List {
 private:
-  struct Node {
+  struct Link {
+    Link* prev = nullptr;
+    Link* next = nullptr;
+  };
+
+  struct Node: Link {
   public:
-    Node* prev = nullptr;
-    Node* next = nullptr;
     T value;
     Node() = default;
 
-    Node(const T& value): value(value) {}
+    template<typename... Args>
+    explicit Node(std::in_place_t, Args&&... args): value(std::forward<Args>(args)...) {}
 
-    Node(Node* prev, Node* next, const T& value): prev(prev), next(next), value(value) {
+    Node(Link* prev, Link* next, const T& value): Link{prev, next}, value(value) {
     }
 
-    Node(const Node& other): next(other.next), prev(other.prev) {
+    Node(const Node& other): Link(other) {
     }
   };
 
@@ -87,41 +460,155 @@ private:
   using NodeAllocator = typename AllocTraits::template rebind_alloc<Node>;
   using NodeAllocTraits= typename AllocTraits::template rebind_traits<Node>;
 
-  Node* fake_node_;
+  // The sentinel is a bare Link inside the container: it owns no value, and moving the
+  // list relinks its neighbours instead of handing it over, so end() never changes.
+  Link fake_node_;
   size_t size_ = 0;
   NodeAllocator alloc_;
 
-  void reserve(size_t size) {
-    for (size_t i = 0; i < size; ++i) {
-      Node* n;
-      try {
-        n = NodeAllocTraits::allocate(alloc_, 1);
-        NodeAllocTraits::construct(alloc_, n);
-      } catch (...){
-        NodeAllocTraits::deallocate(alloc_, n, 1);
-        throw;
+  static Node* as_node(Link* link) {
+    return static_cast<Node*>(link);
+  }
+
+  void reset() {
+    fake_node_.prev = &fake_node_;
+    fake_node_.next = &fake_node_;
+    size_ = 0;
+  }
+
+  // Steals the node chain of `other`; only the neighbours of the sentinel are relinked.
+  void take_chain(List& other) noexcept {
+    if (other.size_ == 0) {
+      reset();
+      return;
+    }
+    fake_node_.next = other.fake_node_.next;
+    fake_node_.prev = other.fake_node_.prev;
+    fake_node_.next->prev = &fake_node_;
+    fake_node_.prev->next = &fake_node_;
+    size_ = other.size_;
+    other.reset();
+  }
+
+  // Builds `count` nodes as a detached chain, constructing node i with construct(node),
+  // and links the chain in front of pos only once every value is in place. Nodes come
+  // from a single allocation when the allocator can later free them one by one.
+  template<typename Construct>
+  Link* insert_nodes(Link* pos, size_t count, Construct construct) {
+    if (count == 0) {
+      return pos;
+    }
+    const bool bulk = allows_partial_deallocation<NodeAllocator>::value;
+    Node* block = bulk ? NodeAllocTraits::allocate(alloc_, count) : nullptr;
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    size_t built = 0;
+    try {
+      for (; built < count; ++built) {
+        Node* n = bulk ? block + built : NodeAllocTraits::allocate(alloc_, 1);
+        try {
+          construct(n);
+        } catch (...) {
+          if (!bulk) {
+            NodeAllocTraits::deallocate(alloc_, n, 1);
+          }
+          throw;
+        }
+        n->prev = tail;
+        if (tail == nullptr) {
+          head = n;
+        } else {
+          tail->next = n;
+        }
+        tail = n;
       }
-      ++size_;
-      if (size_ == 1) {
-        n->prev = fake_node_;
-        n->next = fake_node_;
-        fake_node_->prev = n;
-        fake_node_->next = n;
+    } catch (...) {
+      for (size_t i = 0; i < built; ++i) {
+        Node* next = as_node(head->next);
+        NodeAllocTraits::destroy(alloc_, head);
+        if (!bulk) {
+          NodeAllocTraits::deallocate(alloc_, head, 1);
+        }
+        head = next;
+      }
+      if (bulk) {
+        NodeAllocTraits::deallocate(alloc_, block, count);
+      }
+      throw;
+    }
+    head->prev = pos->prev;
+    pos->prev->next = head;
+    tail->next = pos;
+    pos->prev = tail;
+    size_ += count;
+    return head;
+  }
+
+  void reserve(size_t size) {
+    insert_nodes(&fake_node_, size, [this](Node* n) {
+      NodeAllocTraits::construct(alloc_, n);
+    });
+  }
+
+  template<typename InputIt>
+  Link* insert_range(Link* pos, InputIt first, InputIt last, std::input_iterator_tag) {
+    List chain(alloc_);
+    for (; first != last; ++first) {
+      chain.emplace_back(*first);
+    }
+    Link* head = chain.size_ == 0 ? pos : chain.fake_node_.next;
+    transfer(pos, chain.fake_node_.next, &chain.fake_node_);
+    size_ += chain.size_;
+    chain.size_ = 0;
+    return head;
+  }
+
+  template<typename ForwardIt>
+  Link* insert_range(Link* pos, ForwardIt first, ForwardIt last, std::forward_iterator_tag) {
+    return insert_nodes(pos, std::distance(first, last), [this, &first](Node* n) {
+      NodeAllocTraits::construct(alloc_, n, std::in_place, *first);
+      ++first;
+    });
+  }
+
+  // Moves [first, last) in front of pos by relinking; the range must not contain pos.
+  static void transfer(Link* pos, Link* first, Link* last) {
+    if (first == last || pos == first || pos == last) {
+      return;
+    }
+    Link* tail = last->prev;
+    first->prev->next = last;
+    last->prev = first->prev;
+    first->prev = pos->prev;
+    tail->next = pos;
+    pos->prev->next = first;
+    pos->prev = tail;
+  }
 
+  // Merges two nullptr-terminated chains linked through `next` only; ties keep `left` first.
+  template<typename Compare>
+  static Link* merge_chains(Link* left, Link* right, Compare& compare) {
+    Link* result = nullptr;
+    Link** tail = &result;
+    while (left != nullptr && right != nullptr) {
+      if (compare(as_node(right)->value, as_node(left)->value)) {
+        *tail = right;
+        right = right->next;
       } else {
-        n->prev = (end().node)->prev;
-        n->next = end().node;
-        (n->prev)->next = n;
-        (end().node)->prev = n;
+        *tail = left;
+        left = left->next;
       }
+      tail = &(*tail)->next;
     }
+    *tail = (left != nullptr ? left : right);
+    return result;
   }
 
 public:
   template<bool constant>
   class Iterator {
   private:
-    Node* node = nullptr;
+    Link* node = nullptr;
 
     friend class List<T, allocator>;
   public:
@@ -135,7 +622,7 @@ public:
 
     Iterator() = default;
 
-    Iterator(Node* node): node(node) {};
+    Iterator(Link* node): node(node) {};
 
     Iterator(const Iterator<false>& other): node(other.node) {};
 
@@ -177,12 +664,12 @@ public:
 
 
     reference operator*() const {
-      return node->value;
+      return as_node(node)->value;
     }
 
 
     pointer operator->() const {
-      return &(node->value);
+      return &(as_node(node)->value);
     }
 
   };
@@ -194,14 +681,7 @@ public:
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
   List(): alloc_(NodeAllocator())  {
-    try {
-      fake_node_ = NodeAllocTraits::allocate(alloc_, 1);
-    } catch(...) {
-      NodeAllocTraits::deallocate(alloc_, fake_node_, 1);
-      throw;
-    }
-    fake_node_->prev = fake_node_;
-    fake_node_->next = fake_node_;
+    reset();
   }
 
   List(size_t size): List() {
@@ -209,16 +689,21 @@ public:
   }
 
   List(size_t size, const T& value): List() {
-    for (size_t i = 0; i < size; ++i) {
-      push_back(value);
-    }
+    insert(cend(), size, value);
+  }
+
+  template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  List(InputIt first, InputIt last, const allocator& alloc = allocator()): List(alloc) {
+    insert(cend(), first, last);
+  }
+
+  List(std::initializer_list<T> values, const allocator& alloc = allocator()): List(alloc) {
+    insert(cend(), values.begin(), values.end());
   }
 
   List(const allocator& a): alloc_(NodeAllocTraits::select_on_container_copy_construction(a))
   {
-    fake_node_ = NodeAllocTraits::allocate(alloc_, 1);
-    fake_node_->prev = fake_node_;
-    fake_node_->next = fake_node_;
+    reset();
   }
 
   List(size_t size, const allocator& alloc): List(alloc) {
@@ -227,55 +712,71 @@ public:
 
 
   List(size_t size, const T& value, const allocator& alloc): List(alloc) {
-    for (size_t i = 0; i < size; ++i) {
-      push_back(value);
-    }
+    insert(cend(), size, value);
   }
 
   allocator get_allocator() {
     return alloc_;
   }
 
-  List(const List& other): List(NodeAllocTraits::select_on_container_copy_construction(other.alloc)) {
-    Node* n = other.fake_node_;
-    for(size_t i = 0; i < other.size_; ++i) {
-      n = n->next;
-      try {
-        push_back(n->value);
-      } catch(...) {
-        for (size_t j = 0; j < i; ++j) {
-          pop_back();
-        }
-        throw;
-      }
+  List(const List& other): List(NodeAllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    for (const_iterator iter = other.cbegin(); iter != other.cend(); ++iter) {
+      push_back(*iter);
     }
   }
 
-  List& operator=(const List& other) {
+  List(const List& other, const allocator& alloc): List(alloc) {
+    for (const_iterator iter = other.cbegin(); iter != other.cend(); ++iter) {
+      push_back(*iter);
+    }
+  }
 
+  // Moving relinks the node chain onto this sentinel and allocates nothing; the source
+  // is left empty with its own sentinel, so its end() stays valid.
+  List(List&& other) noexcept: alloc_(other.alloc_) {
+    take_chain(other);
+  }
 
-    if (AllocTraits::propagate_on_container_copy_assignment::value) {
-      alloc_ = other.alloc;
+  List(List&& other, const allocator& alloc): List(alloc) {
+    if (alloc_ == other.alloc_) {
+      take_chain(other);
+      return;
     }
-
-    Node* n = other.fake_node_;
-    for(size_t i = 0; i < other.size_; ++i) {
-      n = n->next;
-      try {
-        push_back(n->value);
-      } catch(...) {
-        for (size_t j = 0; j < i; ++j) {
-          pop_back();
-        }
-        throw;
-      }
+    for (iterator iter = other.begin(); iter != other.end(); ++iter) {
+      emplace_back(std::move(*iter));
     }
+  }
 
-    while(size_ > other.size()) {
-      pop_back();
+  List& operator=(const List& other) {
+    if (this == &other) {
+      return *this;
     }
+    const bool propagate = AllocTraits::propagate_on_container_copy_assignment::value;
+    List copy(other, propagate ? allocator(other.alloc_) : allocator(alloc_));
+    clear();
+    if (propagate) {
+      alloc_ = copy.alloc_;
+    }
+    take_chain(copy);
+    return *this;
+  }
 
-
+  List& operator=(List&& other) noexcept(NodeAllocTraits::propagate_on_container_move_assignment::value ||
+                                         NodeAllocTraits::is_always_equal::value) {
+    if (this == &other) {
+      return *this;
+    }
+    if (alloc_ == other.alloc_ || NodeAllocTraits::propagate_on_container_move_assignment::value) {
+      clear();
+      if (NodeAllocTraits::propagate_on_container_move_assignment::value) {
+        alloc_ = other.alloc_;
+      }
+      take_chain(other);
+    } else {
+      List moved(std::move(other), alloc_);
+      clear();
+      take_chain(moved);
+    }
     return *this;
   }
 
@@ -284,11 +785,29 @@ public:
   }
 
   void push_back(const T& value) {
-    insert(end(), value);
+    emplace(end(), value);
+  }
+
+  void push_back(T&& value) {
+    emplace(end(), std::move(value));
   }
 
   void push_front(const T& value) {
-    insert(begin(), value);
+    emplace(begin(), value);
+  }
+
+  void push_front(T&& value) {
+    emplace(begin(), std::move(value));
+  }
+
+  template<typename... Args>
+  T& emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+
+  template<typename... Args>
+  T& emplace_front(Args&&... args) {
+    return *emplace(begin(), std::forward<Args>(args)...);
   }
 
   void pop_back() {
@@ -301,80 +820,951 @@ public:
   }
 
   iterator begin() const {
-    return iterator(fake_node_->next);
+    return iterator(fake_node_.next);
   }
 
   iterator end() const {
-    return iterator(fake_node_);
+    return iterator(const_cast<Link*>(&fake_node_));
   }
 
   const_iterator cbegin() const {
-    return const_iterator(fake_node_->next);
+    return const_iterator(fake_node_.next);
   }
 
   const_iterator cend() const {
-    return const_iterator(fake_node_);
+    return const_iterator(const_cast<Link*>(&fake_node_));
   }
 
   reverse_iterator rbegin() const {
-    return reverse_iterator(fake_node_);
+    return reverse_iterator(end());
   }
 
   reverse_iterator rend() const {
-    return reverse_iterator(fake_node_);
+    return reverse_iterator(end());
   }
 
   const_reverse_iterator rcbegin() const {
-    return const_reverse_iterator(fake_node_);
+    return const_reverse_iterator(cend());
   }
 
   const_reverse_iterator rcend() const {
-    return const_reverse_iterator(fake_node_);
+    return const_reverse_iterator(cend());
   }
 
-  void insert(const_iterator iter, const T& value) {
-    Node* n;
+  template<typename... Args>
+  iterator emplace(const_iterator iter, Args&&... args) {
+    Link* at = iter.node;
+    Node* n = NodeAllocTraits::allocate(alloc_, 1);
     try {
-      n = NodeAllocTraits::allocate(alloc_, 1);
-      NodeAllocTraits::construct(alloc_, n, value);
+      NodeAllocTraits::construct(alloc_, n, std::in_place, std::forward<Args>(args)...);
     } catch (...){
       NodeAllocTraits::deallocate(alloc_, n, 1);
       throw;
     }
     ++size_;
-    if (size_ == 1) {
-      n->prev = fake_node_;
-      n->next = fake_node_;
-      fake_node_->prev = n;
-      fake_node_->next = n;
+    n->prev = at->prev;
+    n->next = at;
+    (n->prev)->next = n;
+    at->prev = n;
+    return iterator(n);
+  }
 
-    } else {
-      n->prev = (iter.node)->prev;
-      n->next = iter.node;
-      (n->prev)->next = n;
-      (iter.node)->prev = n;
-    }
+  iterator insert(const_iterator iter, const T& value) {
+    return emplace(iter, value);
+  }
+
+  iterator insert(const_iterator iter, T&& value) {
+    return emplace(iter, std::move(value));
+  }
+
+  iterator insert(const_iterator iter, size_t count, const T& value) {
+    return iterator(insert_nodes(iter.node, count, [this, &value](Node* n) {
+      NodeAllocTraits::construct(alloc_, n, std::in_place, value);
+    }));
+  }
+
+  template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  iterator insert(const_iterator iter, InputIt first, InputIt last) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    return iterator(insert_range(iter.node, first, last, Category()));
+  }
+
+  iterator insert(const_iterator iter, std::initializer_list<T> values) {
+    return insert(iter, values.begin(), values.end());
+  }
+
+  // The replacement is built aside and swapped in, so a throwing copy leaves the list as it was.
+  template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  void assign(InputIt first, InputIt last) {
+    List replacement(first, last, alloc_);
+    clear();
+    take_chain(replacement);
+  }
+
+  void assign(size_t count, const T& value) {
+    List replacement(count, value, alloc_);
+    clear();
+    take_chain(replacement);
+  }
+
+  void assign(std::initializer_list<T> values) {
+    assign(values.begin(), values.end());
   }
 
   void erase(const_iterator iter) {
     --size_;
     if (size_ == 0) {
-      fake_node_ -> prev = fake_node_;
-      fake_node_ -> next = fake_node_;
+      fake_node_.prev = &fake_node_;
+      fake_node_.next = &fake_node_;
 
     } else {
       ((iter.node)->prev)->next = iter.node->next;
       ((iter.node)->next)->prev = iter.node->prev;
     }
-    NodeAllocTraits::destroy(alloc_, iter.node);
-    NodeAllocTraits::deallocate(alloc_, iter.node, 1);
+    NodeAllocTraits::destroy(alloc_, as_node(iter.node));
+    NodeAllocTraits::deallocate(alloc_, as_node(iter.node), 1);
   }
 
-  ~List() {
+  // splice, merge and sort only relink nodes: nothing is allocated, constructed
+  // or copied. Both lists must use equal allocators.
+  void splice(const_iterator pos, List& other) {
+    if (this == &other || other.size_ == 0) {
+      return;
+    }
+    transfer(pos.node, other.fake_node_.next, &other.fake_node_);
+    size_ += other.size_;
+    other.size_ = 0;
+  }
+
+  void splice(const_iterator pos, List&& other) {
+    splice(pos, other);
+  }
+
+  void splice(const_iterator pos, List& other, const_iterator iter) {
+    Link* at = pos.node;
+    Link* next = iter.node->next;
+    if (at == iter.node || at == next) {
+      return;
+    }
+    transfer(at, iter.node, next);
+    --other.size_;
+    ++size_;
+  }
+
+  void splice(const_iterator pos, List&& other, const_iterator iter) {
+    splice(pos, other, iter);
+  }
+
+  void splice(const_iterator pos, List& other, const_iterator first, const_iterator last) {
+    if (this != &other) {
+      size_t count = 0;
+      for (const_iterator iter = first; iter != last; ++iter) {
+        ++count;
+      }
+      other.size_ -= count;
+      size_ += count;
+    }
+    transfer(pos.node, first.node, last.node);
+  }
+
+  void splice(const_iterator pos, List&& other, const_iterator first, const_iterator last) {
+    splice(pos, other, first, last);
+  }
+
+  template<typename Compare>
+  void merge(List& other, Compare compare) {
+    if (this == &other || other.size_ == 0) {
+      return;
+    }
+    Link* pos = fake_node_.next;
+    Link* node = other.fake_node_.next;
+    while (node != &other.fake_node_) {
+      if (pos == &fake_node_) {
+        transfer(pos, node, &other.fake_node_);
+        break;
+      }
+      if (compare(as_node(node)->value, as_node(pos)->value)) {
+        Link* next = node->next;
+        transfer(pos, node, next);
+        node = next;
+      } else {
+        pos = pos->next;
+      }
+    }
+    size_ += other.size_;
+    other.size_ = 0;
+  }
+
+  template<typename Compare>
+  void merge(List&& other, Compare compare) {
+    merge(other, compare);
+  }
+
+  void merge(List& other) {
+    merge(other, std::less<T>());
+  }
+
+  void merge(List&& other) {
+    merge(other, std::less<T>());
+  }
+
+  // Stable bottom-up merge sort: runs[i] holds a sorted chain of 2^i nodes, as in
+  // a binary counter, so the whole sort is one pass over the list plus the merges.
+  template<typename Compare>
+  void sort(Compare compare) {
+    if (size_ < 2) {
+      return;
+    }
+    Link* runs[64] = {};
+    Link* node = fake_node_.next;
+    fake_node_.prev->next = nullptr;
+    while (node != nullptr) {
+      Link* next = node->next;
+      node->next = nullptr;
+      Link* carry = node;
+      size_t i = 0;
+      for (; runs[i] != nullptr; ++i) {
+        carry = merge_chains(runs[i], carry, compare);
+        runs[i] = nullptr;
+      }
+      runs[i] = carry;
+      node = next;
+    }
+    Link* sorted = nullptr;
+    for (Link* run: runs) {
+      if (run != nullptr) {
+        sorted = merge_chains(run, sorted, compare);
+      }
+    }
+    Link* prev = &fake_node_;
+    for (node = sorted; node != nullptr; node = node->next) {
+      node->prev = prev;
+      prev->next = node;
+      prev = node;
+    }
+    prev->next = &fake_node_;
+    fake_node_.prev = prev;
+  }
+
+  void sort() {
+    sort(std::less<T>());
+  }
+
+  void clear() {
     while (size_) {
       pop_back();
     }
-    NodeAllocTraits::deallocate(alloc_, fake_node_, 1);
+  }
+
+  ~List() {
+    clear();
   }
 };
 
+
+// Unrolled list: every node stores up to kCapacity values inline with a fill count,
+// so traversal touches one cache-friendly block per kCapacity elements. A full node
+// is split in half on insert; a node that falls below half after erase borrows from
+// or merges with its successor, which keeps all nodes but the last at least half full.
+// The sentinel is a bare Link inside the container, so it owns no element storage.
+// The default capacity keeps a node within 256 bytes, so a StackStorage recycles
+// freed nodes through its size-class free lists.
+template <typename T, typename allocator = std::allocator<T>,
+          size_t kCapacity = (sizeof(T) <= 58 ? 232 / sizeof(T) : 4)>
+class UnrolledList {
+private:
+  static_assert(kCapacity >= 2, "an unrolled node must hold at least two values");
+
+  struct Link {
+    Link* prev = nullptr;
+    Link* next = nullptr;
+    size_t count = 0;
+  };
+
+  struct Node: Link {
+    alignas(T) unsigned char storage[sizeof(T) * kCapacity];
+
+    T* slot(size_t index) {
+      return reinterpret_cast<T*>(storage) + index;
+    }
+  };
+
+  using AllocTraits = typename std::allocator_traits<allocator>;
+  using NodeAllocator = typename AllocTraits::template rebind_alloc<Node>;
+  using NodeAllocTraits = typename AllocTraits::template rebind_traits<Node>;
+
+  Link fake_node_;
+  size_t size_ = 0;
+  NodeAllocator alloc_;
+
+  static Node* as_node(Link* link) {
+    return static_cast<Node*>(link);
+  }
+
+  void reset() {
+    fake_node_.prev = &fake_node_;
+    fake_node_.next = &fake_node_;
+    size_ = 0;
+  }
+
+  Node* create_node_after(Link* link) {
+    Node* node = NodeAllocTraits::allocate(alloc_, 1);
+    node->count = 0;
+    node->prev = link;
+    node->next = link->next;
+    link->next->prev = node;
+    link->next = node;
+    return node;
+  }
+
+  void destroy_node(Node* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    NodeAllocTraits::deallocate(alloc_, node, 1);
+  }
+
+  // Moves `count` values starting at from->slot(first) to the end of `to`.
+  void move_values(Node* from, size_t first, size_t count, Node* to) {
+    for (size_t i = 0; i < count; ++i) {
+      NodeAllocTraits::construct(alloc_, to->slot(to->count), std::move(*from->slot(first + i)));
+      ++to->count;
+      NodeAllocTraits::destroy(alloc_, from->slot(first + i));
+    }
+  }
+
+  // Steals the node chain of `other`; only the neighbours of the sentinel are relinked.
+  void take_chain(UnrolledList& other) {
+    if (other.size_ == 0) {
+      reset();
+      return;
+    }
+    fake_node_.next = other.fake_node_.next;
+    fake_node_.prev = other.fake_node_.prev;
+    fake_node_.next->prev = &fake_node_;
+    fake_node_.prev->next = &fake_node_;
+    size_ = other.size_;
+    other.reset();
+  }
+
+public:
+  template<bool constant>
+  class Iterator {
+  private:
+    Link* node = nullptr;
+    size_t index = 0;
+
+    friend class UnrolledList;
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = typename std::conditional<constant, const T, T>::type;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = typename std::conditional<constant, const T*, T*>::type;
+    using reference = typename std::conditional<constant, const T&, T&>::type;
+
+    Iterator() = default;
+
+    Iterator(Link* node, size_t index): node(node), index(index) {}
+
+    Iterator(const Iterator<false>& other): node(other.node), index(other.index) {}
+
+    Iterator& operator++() {
+      if (++index == node->count) {
+        node = node->next;
+        index = 0;
+      }
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator iterator = *this;
+      ++(*this);
+      return iterator;
+    }
+
+    Iterator& operator--() {
+      if (index == 0) {
+        node = node->prev;
+        index = node->count;
+      }
+      --index;
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      Iterator iterator = *this;
+      --(*this);
+      return iterator;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return node == other.node && index == other.index;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return !(*this == other);
+    }
+
+    reference operator*() const {
+      return *as_node(node)->slot(index);
+    }
+
+    pointer operator->() const {
+      return as_node(node)->slot(index);
+    }
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  UnrolledList(): UnrolledList(allocator()) {}
+
+  UnrolledList(const allocator& alloc): alloc_(alloc) {
+    reset();
+  }
+
+  UnrolledList(size_t size, const T& value, const allocator& alloc = allocator()): UnrolledList(alloc) {
+    for (size_t i = 0; i < size; ++i) {
+      push_back(value);
+    }
+  }
+
+  UnrolledList(const UnrolledList& other):
+      UnrolledList(other, NodeAllocTraits::select_on_container_copy_construction(other.alloc_)) {}
+
+  UnrolledList(const UnrolledList& other, const allocator& alloc): UnrolledList(alloc) {
+    try {
+      for (const T& value: other) {
+        push_back(value);
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  UnrolledList(UnrolledList&& other): alloc_(other.alloc_) {
+    take_chain(other);
+  }
+
+  UnrolledList(UnrolledList&& other, const allocator& alloc): UnrolledList(alloc) {
+    if (alloc_ == other.alloc_) {
+      take_chain(other);
+      return;
+    }
+    try {
+      for (T& value: other) {
+        push_back(std::move(value));
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  UnrolledList& operator=(const UnrolledList& other) {
+    if (this == &other) {
+      return *this;
+    }
+    const bool propagate = AllocTraits::propagate_on_container_copy_assignment::value;
+    UnrolledList copy(other, propagate ? allocator(other.alloc_) : allocator(alloc_));
+    clear();
+    if (propagate) {
+      alloc_ = copy.alloc_;
+    }
+    take_chain(copy);
+    return *this;
+  }
+
+  UnrolledList& operator=(UnrolledList&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    if (alloc_ == other.alloc_ || NodeAllocTraits::propagate_on_container_move_assignment::value) {
+      clear();
+      if (NodeAllocTraits::propagate_on_container_move_assignment::value) {
+        alloc_ = other.alloc_;
+      }
+      take_chain(other);
+    } else {
+      UnrolledList moved(std::move(other), alloc_);
+      clear();
+      take_chain(moved);
+    }
+    return *this;
+  }
+
+  ~UnrolledList() {
+    clear();
+  }
+
+  allocator get_allocator() const {
+    return alloc_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  // Number of values a node holds; useful for sizing a StackStorage.
+  static constexpr size_t node_capacity() {
+    return kCapacity;
+  }
+
+  iterator begin() {
+    return iterator(fake_node_.next, 0);
+  }
+
+  iterator end() {
+    return iterator(&fake_node_, 0);
+  }
+
+  const_iterator begin() const {
+    return cbegin();
+  }
+
+  const_iterator end() const {
+    return cend();
+  }
+
+  const_iterator cbegin() const {
+    return const_iterator(fake_node_.next, 0);
+  }
+
+  const_iterator cend() const {
+    return const_iterator(const_cast<Link*>(&fake_node_), 0);
+  }
+
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(cend());
+  }
+
+  const_reverse_iterator crend() const {
+    return const_reverse_iterator(cbegin());
+  }
+
+  T& front() {
+    return *begin();
+  }
+
+  T& back() {
+    return *--end();
+  }
+
+  template<typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    Link* link = pos.node;
+    size_t index = pos.index;
+    if (link == &fake_node_) {
+      link = fake_node_.prev;
+      index = link->count;
+      if (link == &fake_node_ || link->count == kCapacity) {
+        link = create_node_after(link);
+        index = 0;
+      }
+    }
+    Node* node = as_node(link);
+    if (node->count == kCapacity) {
+      Node* upper = create_node_after(node);
+      size_t half = kCapacity / 2;
+      move_values(node, half, kCapacity - half, upper);
+      node->count = half;
+      if (index > half) {
+        node = upper;
+        index -= half;
+      }
+    }
+    try {
+      if (index == node->count) {
+        NodeAllocTraits::construct(alloc_, node->slot(index), std::forward<Args>(args)...);
+      } else {
+        T value(std::forward<Args>(args)...);
+        T* last = node->slot(node->count - 1);
+        NodeAllocTraits::construct(alloc_, last + 1, std::move(*last));
+        std::move_backward(node->slot(index), last, last + 1);
+        *node->slot(index) = std::move(value);
+      }
+    } catch (...) {
+      if (node->count == 0) {
+        destroy_node(node);
+      }
+      throw;
+    }
+    ++node->count;
+    ++size_;
+    return iterator(node, index);
+  }
+
+  iterator insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  template<typename... Args>
+  T& emplace_back(Args&&... args) {
+    return *emplace(cend(), std::forward<Args>(args)...);
+  }
+
+  template<typename... Args>
+  T& emplace_front(Args&&... args) {
+    return *emplace(cbegin(), std::forward<Args>(args)...);
+  }
+
+  void push_back(const T& value) {
+    emplace(cend(), value);
+  }
+
+  void push_back(T&& value) {
+    emplace(cend(), std::move(value));
+  }
+
+  void push_front(const T& value) {
+    emplace(cbegin(), value);
+  }
+
+  void push_front(T&& value) {
+    emplace(cbegin(), std::move(value));
+  }
+
+  iterator erase(const_iterator pos) {
+    Node* node = as_node(pos.node);
+    size_t index = pos.index;
+    std::move(node->slot(index + 1), node->slot(node->count), node->slot(index));
+    NodeAllocTraits::destroy(alloc_, node->slot(node->count - 1));
+    --node->count;
+    --size_;
+    if (node->count == 0) {
+      Link* next = node->next;
+      destroy_node(node);
+      return iterator(next, 0);
+    }
+    if (node->count < kCapacity / 2 && node->next != &fake_node_) {
+      Node* next = as_node(node->next);
+      if (node->count + next->count > kCapacity) {
+        NodeAllocTraits::construct(alloc_, node->slot(node->count), std::move(*next->slot(0)));
+        ++node->count;
+        std::move(next->slot(1), next->slot(next->count), next->slot(0));
+        NodeAllocTraits::destroy(alloc_, next->slot(next->count - 1));
+        --next->count;
+      } else {
+        move_values(next, 0, next->count, node);
+        destroy_node(next);
+      }
+    }
+    if (index == node->count) {
+      return iterator(node->next, 0);
+    }
+    return iterator(node, index);
+  }
+
+  void pop_back() {
+    erase(--cend());
+  }
+
+  void pop_front() {
+    erase(cbegin());
+  }
+
+  void clear() {
+    Link* link = fake_node_.next;
+    while (link != &fake_node_) {
+      Node* node = as_node(link);
+      link = link->next;
+      for (size_t i = 0; i < node->count; ++i) {
+        NodeAllocTraits::destroy(alloc_, node->slot(i));
+      }
+      NodeAllocTraits::deallocate(alloc_, node, 1);
+    }
+    reset();
+  }
+};
+
+// Links embedded in a user type for IntrusiveList; a type with several hooks can
+// sit in several lists at once. The hook unlinks itself on destruction, and
+// copying an object does not copy its list membership.
+class ListHook {
+private:
+  ListHook* prev_ = nullptr;
+  ListHook* next_ = nullptr;
+
+  template <typename T, ListHook T::*Hook>
+  friend class IntrusiveList;
+
+public:
+  ListHook() = default;
+
+  ListHook(const ListHook&) {}
+
+  ListHook& operator=(const ListHook&) {
+    return *this;
+  }
+
+  bool is_linked() const {
+    return next_ != nullptr;
+  }
+
+  // O(1) removal from whatever list holds the object; no-op when unlinked.
+  void unlink() {
+    if (next_ == nullptr) {
+      return;
+    }
+    prev_->next_ = next_;
+    next_->prev_ = prev_;
+    prev_ = nullptr;
+    next_ = nullptr;
+  }
+
+  ~ListHook() {
+    unlink();
+  }
+};
+
+// List over objects owned elsewhere, threaded through the ListHook member Hook.
+// Same circular layout as List, with a hook as the sentinel, but elements are never
+// allocated, copied or destroyed. Because hooks can unlink
+// themselves, the list keeps no element count and size() walks the chain.
+template <typename T, ListHook T::*Hook>
+class IntrusiveList {
+private:
+  ListHook fake_node_;
+
+  static T* owner(ListHook* hook) {
+    const T* probe = reinterpret_cast<const T*>(alignof(T));
+    std::ptrdiff_t offset = reinterpret_cast<const char*>(&(probe->*Hook)) - reinterpret_cast<const char*>(probe);
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - offset);
+  }
+
+  void reset() {
+    fake_node_.prev_ = &fake_node_;
+    fake_node_.next_ = &fake_node_;
+  }
+
+  void take_chain(IntrusiveList& other) {
+    if (other.empty()) {
+      reset();
+      return;
+    }
+    fake_node_.prev_ = other.fake_node_.prev_;
+    fake_node_.next_ = other.fake_node_.next_;
+    fake_node_.prev_->next_ = &fake_node_;
+    fake_node_.next_->prev_ = &fake_node_;
+    other.reset();
+  }
+
+public:
+  template<bool constant>
+  class Iterator {
+  private:
+    ListHook* node = nullptr;
+
+    friend class IntrusiveList;
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = typename std::conditional<constant, const T, T>::type;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = typename std::conditional<constant, const T*, T*>::type;
+    using reference = typename std::conditional<constant, const T&, T&>::type;
+
+    Iterator() = default;
+
+    explicit Iterator(ListHook* node): node(node) {}
+
+    Iterator(const Iterator<false>& other): node(other.node) {}
+
+    Iterator& operator++() {
+      node = node->next_;
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator iterator = *this;
+      ++(*this);
+      return iterator;
+    }
+
+    Iterator& operator--() {
+      node = node->prev_;
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      Iterator iterator = *this;
+      --(*this);
+      return iterator;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return node == other.node;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return node != other.node;
+    }
+
+    reference operator*() const {
+      return *owner(node);
+    }
+
+    pointer operator->() const {
+      return owner(node);
+    }
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  IntrusiveList() {
+    reset();
+  }
+
+  IntrusiveList(const IntrusiveList&) = delete;
+  IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+  IntrusiveList(IntrusiveList&& other) {
+    take_chain(other);
+  }
+
+  IntrusiveList& operator=(IntrusiveList&& other) {
+    if (this != &other) {
+      clear();
+      take_chain(other);
+    }
+    return *this;
+  }
+
+  ~IntrusiveList() {
+    clear();
+  }
+
+  // The element's own position, for O(1) erase or splice of an object found elsewhere.
+  static iterator iterator_to(T& value) {
+    return iterator(&(value.*Hook));
+  }
+
+  iterator begin() {
+    return iterator(fake_node_.next_);
+  }
+
+  iterator end() {
+    return iterator(&fake_node_);
+  }
+
+  const_iterator begin() const {
+    return cbegin();
+  }
+
+  const_iterator end() const {
+    return cend();
+  }
+
+  const_iterator cbegin() const {
+    return const_iterator(fake_node_.next_);
+  }
+
+  const_iterator cend() const {
+    return const_iterator(const_cast<ListHook*>(&fake_node_));
+  }
+
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+
+  bool empty() const {
+    return fake_node_.next_ == &fake_node_;
+  }
+
+  size_t size() const {
+    size_t count = 0;
+    for (const ListHook* node = fake_node_.next_; node != &fake_node_; node = node->next_) {
+      ++count;
+    }
+    return count;
+  }
+
+  T& front() {
+    return *begin();
+  }
+
+  T& back() {
+    return *--end();
+  }
+
+  // The value must not already be linked through Hook.
+  iterator insert(const_iterator pos, T& value) {
+    ListHook* hook = &(value.*Hook);
+    hook->prev_ = pos.node->prev_;
+    hook->next_ = pos.node;
+    hook->prev_->next_ = hook;
+    pos.node->prev_ = hook;
+    return iterator(hook);
+  }
+
+  void push_back(T& value) {
+    insert(cend(), value);
+  }
+
+  void push_front(T& value) {
+    insert(cbegin(), value);
+  }
+
+  iterator erase(const_iterator pos) {
+    ListHook* next = pos.node->next_;
+    pos.node->unlink();
+    return iterator(next);
+  }
+
+  void erase(T& value) {
+    (value.*Hook).unlink();
+  }
+
+  void pop_back() {
+    erase(--cend());
+  }
+
+  void pop_front() {
+    erase(cbegin());
+  }
+
+  // Moves an element (from this or another list on the same hook) in front of pos.
+  void splice(const_iterator pos, T& value) {
+    ListHook* hook = &(value.*Hook);
+    if (hook == pos.node) {
+      return;
+    }
+    hook->unlink();
+    insert(pos, value);
+  }
+
+  void clear() {
+    ListHook* node = fake_node_.next_;
+    while (node != &fake_node_) {
+      ListHook* next = node->next_;
+      node->prev_ = nullptr;
+      node->next_ = nullptr;
+      node = next;
+    }
+    reset();
+  }
+};
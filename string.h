@@ -1,129 +1,759 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
-class String {
+// Substring search over raw bytes. Positions are absolute; text_size means "not found".
+// Short patterns are located by filtering candidates on their first and last byte
+// (16 at a time with SSE2), long ones by Boyer-Moore-Horspool.
+class SubstringSearch {
 private:
-  size_t size;
-  size_t capacity;
-  char* buffer;
+  static const size_t kHorspool_min_pattern = 32;
+
+  static size_t short_find(const char* text, size_t text_size, const char* pattern, size_t pattern_size,
+                           size_t begin) {
+    size_t last = text_size - pattern_size;
+    size_t i = begin;
+#if defined(__SSE2__)
+    const __m128i first_byte = _mm_set1_epi8(pattern[0]);
+    const __m128i last_byte = _mm_set1_epi8(pattern[pattern_size - 1]);
+    for (; i + 16 <= last + 1; i += 16) {
+      __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+      __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + pattern_size - 1));
+      unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+          _mm_and_si128(_mm_cmpeq_epi8(block_first, first_byte), _mm_cmpeq_epi8(block_last, last_byte))));
+      while (mask != 0) {
+        size_t candidate = i + __builtin_ctz(mask);
+        if (memcmp(text + candidate + 1, pattern + 1, pattern_size - 1) == 0) {
+          return candidate;
+        }
+        mask &= mask - 1;
+      }
+    }
+#endif
+    while (i <= last) {
+      const void* hit = memchr(text + i, pattern[0], last - i + 1);
+      if (hit == nullptr) {
+        break;
+      }
+      i = static_cast<const char*>(hit) - text;
+      if (text[i + pattern_size - 1] == pattern[pattern_size - 1] &&
+          memcmp(text + i + 1, pattern + 1, pattern_size - 1) == 0) {
+        return i;
+      }
+      ++i;
+    }
+    return text_size;
+  }
+
+  static size_t horspool_find(const char* text, size_t text_size, const char* pattern, size_t pattern_size,
+                              size_t begin) {
+    size_t shift[256];
+    std::fill(shift, shift + 256, pattern_size);
+    for (size_t j = 0; j + 1 < pattern_size; ++j) {
+      shift[static_cast<unsigned char>(pattern[j])] = pattern_size - 1 - j;
+    }
+    char last_char = pattern[pattern_size - 1];
+    for (size_t i = begin; i + pattern_size <= text_size;) {
+      char key = text[i + pattern_size - 1];
+      if (key == last_char && memcmp(text + i, pattern, pattern_size - 1) == 0) {
+        return i;
+      }
+      i += shift[static_cast<unsigned char>(key)];
+    }
+    return text_size;
+  }
+
+  static size_t short_rfind(const char* text, size_t text_size, const char* pattern, size_t pattern_size,
+                            size_t end) {
+    for (size_t i = end + 1; i >= 1; --i) {
+      const char* window = text + i - 1;
+      if (window[0] == pattern[0] && window[pattern_size - 1] == pattern[pattern_size - 1] &&
+          memcmp(window + 1, pattern + 1, pattern_size - 1) == 0) {
+        return i - 1;
+      }
+    }
+    return text_size;
+  }
+
+  // Mirror image of Horspool: windows move leftwards keyed on their first byte.
+  static size_t horspool_rfind(const char* text, size_t text_size, const char* pattern, size_t pattern_size,
+                               size_t end) {
+    size_t shift[256];
+    std::fill(shift, shift + 256, pattern_size);
+    for (size_t j = pattern_size - 1; j >= 1; --j) {
+      shift[static_cast<unsigned char>(pattern[j])] = j;
+    }
+    char first_char = pattern[0];
+    for (size_t i = end + 1; i >= 1;) {
+      const char* window = text + i - 1;
+      if (window[0] == first_char && memcmp(window + 1, pattern + 1, pattern_size - 1) == 0) {
+        return i - 1;
+      }
+      size_t step = shift[static_cast<unsigned char>(window[0])];
+      if (step >= i) {
+        break;
+      }
+      i -= step;
+    }
+    return text_size;
+  }
+
+public:
+  static size_t find(const char* text, size_t text_size, const char* pattern, size_t pattern_size,
+                     size_t begin = 0) {
+    if (begin > text_size || pattern_size > text_size - begin) {
+      return text_size;
+    }
+    if (pattern_size == 0) {
+      return begin;
+    }
+    if (pattern_size == 1) {
+      const void* hit = memchr(text + begin, pattern[0], text_size - begin);
+      return hit == nullptr ? text_size : static_cast<const char*>(hit) - text;
+    }
+    if (pattern_size < kHorspool_min_pattern) {
+      return short_find(text, text_size, pattern, pattern_size, begin);
+    }
+    return horspool_find(text, text_size, pattern, pattern_size, begin);
+  }
+
+  // Finds the last occurrence starting at or before `end`.
+  static size_t rfind(const char* text, size_t text_size, const char* pattern, size_t pattern_size,
+                      size_t end = static_cast<size_t>(-1)) {
+    if (pattern_size == 0 || pattern_size > text_size) {
+      return text_size;
+    }
+    end = std::min(end, text_size - pattern_size);
+    if (pattern_size == 1) {
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+      const void* hit = memrchr(text, pattern[0], end + 1);
+      return hit == nullptr ? text_size : static_cast<const char*>(hit) - text;
+#else
+      for (size_t i = end + 1; i-- > 0;) {
+        if (text[i] == pattern[0]) {
+          return i;
+        }
+      }
+      return text_size;
+#endif
+    }
+    if (pattern_size < kHorspool_min_pattern) {
+      return short_rfind(text, text_size, pattern, pattern_size, end);
+    }
+    return horspool_rfind(text, text_size, pattern, pattern_size, end);
+  }
+};
+
+
+// Byte-wise ordering and equality. With SSE2 the common prefix is skipped 16 bytes
+// at a time and only the first differing byte is inspected.
+class StringCompare {
 public:
-  String() : size(0), capacity(1), buffer(nullptr) {};
+  static int compare(const char* first, size_t first_size, const char* second, size_t second_size) {
+    size_t common = std::min(first_size, second_size);
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= common; i += 16) {
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+      __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i));
+      unsigned differ = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) & 0xFFFFu;
+      if (differ != 0) {
+        size_t index = i + __builtin_ctz(differ);
+        return static_cast<unsigned char>(first[index]) < static_cast<unsigned char>(second[index]) ? -1 : 1;
+      }
+    }
+#endif
+    int result = memcmp(first + i, second + i, common - i);
+    if (result != 0) {
+      return result < 0 ? -1 : 1;
+    }
+    return first_size < second_size ? -1 : (first_size > second_size ? 1 : 0);
+  }
+
+  static bool equal(const char* first, size_t first_size, const char* second, size_t second_size) {
+    return first_size == second_size && (first == second || memcmp(first, second, first_size) == 0);
+  }
+};
+
+
+// Fast non-cryptographic 64-bit hash in the style of wyhash: 16-byte lanes (48 at a time
+// for long inputs) folded with 64x64->128 multiply-xor mixing.
+class StringHash {
+private:
+  static constexpr uint64_t kSecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                          0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
 
-  String(const size_t n, char c) : size(n), capacity(2 * n), buffer(new char[n]) {
-    memset(buffer, c, n);
+  static void multiply(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t a_high = a >> 32, a_low = static_cast<uint32_t>(a);
+    uint64_t b_high = b >> 32, b_low = static_cast<uint32_t>(b);
+    uint64_t high = a_high * b_high, middle0 = a_high * b_low, middle1 = a_low * b_high, low = a_low * b_low;
+    uint64_t carry = ((low >> 32) + static_cast<uint32_t>(middle0) + static_cast<uint32_t>(middle1)) >> 32;
+    a = low + (middle0 << 32) + (middle1 << 32);
+    b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
   }
 
-  String(const char* cstring) : size(strlen(cstring)), capacity(2 * size), buffer(new char[size * 2]) {
-    memcpy(buffer, cstring, size);
+  static uint64_t mix(uint64_t a, uint64_t b) {
+    multiply(a, b);
+    return a ^ b;
   }
 
-  String(const char c) : size(1), capacity(1), buffer(new char{c}) {};
+  static uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
 
-  String(const String& other) : size(other.size), capacity(other.size * 2), buffer(new char[other.size * 2]) {
-    memcpy(buffer, other.buffer, size);
+  static uint64_t read32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
   }
 
-  bool operator==(const String& other) const {
-    if (size != other.size) {
-      return false;
+public:
+  static uint64_t hash(const char* data, size_t size, uint64_t seed = 0) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    seed ^= mix(seed ^ kSecret[0], kSecret[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (size <= 16) {
+      if (size >= 4) {
+        size_t shift = (size >> 3) << 2;
+        a = (read32(p) << 32) | read32(p + shift);
+        b = (read32(p + size - 4) << 32) | read32(p + size - 4 - shift);
+      } else if (size > 0) {
+        a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+      }
+    } else {
+      size_t rest = size;
+      if (rest > 48) {
+        uint64_t lane1 = seed;
+        uint64_t lane2 = seed;
+        do {
+          seed = mix(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+          lane1 = mix(read64(p + 16) ^ kSecret[2], read64(p + 24) ^ lane1);
+          lane2 = mix(read64(p + 32) ^ kSecret[3], read64(p + 40) ^ lane2);
+          p += 48;
+          rest -= 48;
+        } while (rest > 48);
+        seed ^= lane1 ^ lane2;
+      }
+      while (rest > 16) {
+        seed = mix(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+        p += 16;
+        rest -= 16;
+      }
+      a = read64(p + rest - 16);
+      b = read64(p + rest - 8);
     }
-    for (size_t i = 0; i < size; ++i) {
-      if (buffer[i] != other.buffer[i]) {
-        return false;
+    a ^= kSecret[1];
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ kSecret[0] ^ size, b ^ kSecret[1]);
+  }
+};
+
+
+// Non-owning window into characters that live elsewhere (a String, a literal, a mapping).
+// It stays valid only as long as the underlying characters do.
+class StringView {
+private:
+  const char* start;
+  size_t size;
+
+public:
+  StringView() : start(""), size(0) {}
+
+  StringView(const char* data, size_t count) : start(data), size(count) {}
+
+  StringView(const char* cstring) : start(cstring), size(strlen(cstring)) {}
+
+  const char* data() const {
+    return start;
+  }
+
+  size_t length() const {
+    return size;
+  }
+
+  bool empty() const {
+    return size == 0;
+  }
+
+  char operator[](size_t index) const {
+    return start[index];
+  }
+
+  char front() const {
+    return start[0];
+  }
+
+  char back() const {
+    return start[size - 1];
+  }
+
+  const char* begin() const {
+    return start;
+  }
+
+  const char* end() const {
+    return start + size;
+  }
+
+  size_t find(StringView substring, size_t begin = 0) const {
+    return SubstringSearch::find(start, size, substring.start, substring.size, begin);
+  }
+
+  size_t rfind(StringView substring) const {
+    return SubstringSearch::rfind(start, size, substring.start, substring.size);
+  }
+
+  size_t find(char c, size_t begin = 0) const {
+    return SubstringSearch::find(start, size, &c, 1, begin);
+  }
+
+  size_t rfind(char c) const {
+    return SubstringSearch::rfind(start, size, &c, 1);
+  }
+
+  int compare(StringView other) const {
+    return StringCompare::compare(start, size, other.start, other.size);
+  }
+
+  uint64_t hash() const {
+    return StringHash::hash(start, size);
+  }
+
+  // Clamped like std::string_view::substr, but never throws.
+  StringView substr(size_t first, size_t count) const {
+    first = std::min(first, size);
+    return StringView(start + first, std::min(count, size - first));
+  }
+};
+
+bool operator==(StringView first, StringView second) {
+  return StringCompare::equal(first.data(), first.length(), second.data(), second.length());
+}
+
+bool operator!=(StringView first, StringView second) {
+  return !(first == second);
+}
+
+bool operator<(StringView first, StringView second) {
+  return first.compare(second) < 0;
+}
+
+bool operator>(StringView first, StringView second) {
+  return first.compare(second) > 0;
+}
+
+bool operator<=(StringView first, StringView second) {
+  return first.compare(second) <= 0;
+}
+
+bool operator>=(StringView first, StringView second) {
+  return first.compare(second) >= 0;
+}
+
+std::ostream& operator<<(std::ostream& out, StringView view) {
+  return out.write(view.data(), static_cast<std::streamsize>(view.length()));
+}
+
+
+// Lazily splits a view on any of the delimiter bytes. Tokens are views into the
+// original text, so iterating allocates nothing.
+class StringSplitter {
+private:
+  StringView text;
+  bool is_delimiter[256] = {};
+  bool skip_empty;
+
+public:
+  class Iterator {
+  private:
+    const StringSplitter* splitter = nullptr;
+    size_t position = 0;
+    StringView token;
+
+    void advance() {
+      const StringView& text = splitter->text;
+      while (position <= text.length()) {
+        size_t stop = position;
+        while (stop < text.length() && !splitter->is_delimiter[static_cast<unsigned char>(text[stop])]) {
+          ++stop;
+        }
+        token = text.substr(position, stop - position);
+        position = stop + 1;
+        if (!splitter->skip_empty || !token.empty()) {
+          return;
+        }
       }
+      splitter = nullptr;
+    }
+
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = StringView;
+    using pointer = const StringView*;
+    using reference = const StringView&;
+    using iterator_category = std::forward_iterator_tag;
+
+    Iterator() = default;
+
+    explicit Iterator(const StringSplitter* splitter) : splitter(splitter) {
+      advance();
+    }
+
+    reference operator*() const {
+      return token;
+    }
+
+    pointer operator->() const {
+      return &token;
+    }
+
+    Iterator& operator++() {
+      advance();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator iterator = *this;
+      advance();
+      return iterator;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return splitter == other.splitter && (splitter == nullptr || position == other.position);
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return !(*this == other);
+    }
+  };
+
+  StringSplitter(StringView text, StringView delimiters, bool skip_empty = true)
+      : text(text), skip_empty(skip_empty) {
+    for (char delimiter: delimiters) {
+      is_delimiter[static_cast<unsigned char>(delimiter)] = true;
+    }
+  }
+
+  Iterator begin() const {
+    return Iterator(this);
+  }
+
+  Iterator end() const {
+    return Iterator();
+  }
+};
+
+StringSplitter split(StringView text, StringView delimiters = " \t\n", bool skip_empty = true) {
+  return StringSplitter(text, delimiters, skip_empty);
+}
+
+
+// Characters are obtained from Allocator, so a String can live in an arena such as
+// StackStorage via StackAllocator<char, N>. String is the std::allocator instance.
+// The heap capacity shares storage with the inline buffer, and an empty allocator
+// takes no space as the base of `storage`, so the inline buffer adds only 8 bytes
+// over a plain {size, pointer, capacity} string.
+template<typename Allocator = std::allocator<char>>
+class BasicString {
+private:
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+  // A member rather than a base of BasicString, so the allocator's operators stay out of lookup.
+  struct Storage : Allocator {
+    char* buffer;
+
+    explicit Storage(const Allocator& alloc): Allocator(alloc) {}
+  };
+
+  static const size_t kLocal_capacity = 15;
+  size_t size;
+  Storage storage;
+  union {
+    size_t reserved;  // valid only while the buffer is on the heap
+    char local_buffer[kLocal_capacity + 1];
+  };
+
+  bool is_local() const {
+    return storage.buffer == local_buffer;
+  }
+
+  Allocator& alloc() {
+    return storage;
+  }
+
+  const Allocator& alloc() const {
+    return storage;
+  }
+
+  // Short strings live in local_buffer, longer ones on the heap; both keep a trailing '\0'.
+  // Writing `reserved` overwrites local_buffer, so it is set only after any copy out of it.
+  char* acquire(size_t n) {
+    return n <= kLocal_capacity ? local_buffer : AllocTraits::allocate(alloc(), n + 1);
+  }
+
+  void adopt(char* new_buffer, size_t n) {
+    storage.buffer = new_buffer;
+    if (new_buffer != local_buffer) {
+      reserved = n;
+    }
+  }
+
+  void allocate(size_t n) {
+    adopt(acquire(n), n);
+  }
+
+  // Geometric growth keeps n appends at O(n) copied bytes and O(log n) allocations.
+  size_t grown_capacity(size_t required) const {
+    return std::max(required, 2 * capacity());
+  }
+
+  void release(char* old_buffer, size_t old_reserved) {
+    if (old_buffer != local_buffer) {
+      AllocTraits::deallocate(alloc(), old_buffer, old_reserved + 1);
+    }
+  }
+
+  void reallocate(size_t new_capacity) {
+    char* old_buffer = storage.buffer;
+    size_t old_reserved = capacity();
+    char* new_buffer = acquire(new_capacity);
+    if (new_buffer == old_buffer) {  // still local; nothing to move or free
+      return;
     }
-    return true;
+    memcpy(new_buffer, old_buffer, size + 1);
+    release(old_buffer, old_reserved);
+    adopt(new_buffer, new_capacity);
+  }
+
+public:
+  BasicString() : BasicString(Allocator()) {}
+
+  explicit BasicString(const Allocator& alloc) : size(0), storage(alloc) {
+    allocate(0);
+    storage.buffer[0] = '\0';
+  }
+
+  BasicString(const size_t n, char c, const Allocator& alloc = Allocator()) : size(n), storage(alloc) {
+    allocate(n);
+    memset(storage.buffer, c, n);
+    storage.buffer[n] = '\0';
+  }
+
+  BasicString(const char* cstring, const Allocator& alloc = Allocator()) : size(strlen(cstring)), storage(alloc) {
+    allocate(size);
+    memcpy(storage.buffer, cstring, size + 1);
+  }
+
+  BasicString(const char c, const Allocator& alloc = Allocator()) : size(1), storage(alloc) {
+    allocate(1);
+    storage.buffer[0] = c;
+    storage.buffer[1] = '\0';
+  }
+
+  explicit BasicString(StringView view, const Allocator& alloc = Allocator()) : size(view.length()), storage(alloc) {
+    allocate(size);
+    memcpy(storage.buffer, view.data(), size);
+    storage.buffer[size] = '\0';
+  }
+
+  BasicString(const BasicString& other, const Allocator& alloc)
+      : size(other.size), storage(alloc) {
+    allocate(size);
+    memcpy(storage.buffer, other.storage.buffer, size + 1);
+  }
+
+  BasicString(const BasicString& other)
+      : BasicString(other, AllocTraits::select_on_container_copy_construction(other.alloc())) {}
+
+  BasicString(BasicString&& other) noexcept : size(other.size), storage(std::move(other.alloc())) {
+    storage.buffer = other.storage.buffer;
+    if (other.is_local()) {
+      storage.buffer = local_buffer;
+      memcpy(local_buffer, other.local_buffer, size + 1);
+    } else {
+      reserved = other.reserved;
+    }
+    other.size = 0;
+    other.storage.buffer = other.local_buffer;
+    other.local_buffer[0] = '\0';
+  }
+
+  Allocator get_allocator() const {
+    return alloc();
+  }
+
+  bool operator==(StringView other) const {
+    return StringCompare::equal(storage.buffer, size, other.data(), other.length());
+  }
+
+  bool operator==(char c) const {
+    return size == 1 && storage.buffer[0] == c;
+  }
+
+  bool operator!=(char c) const {
+    return !(*this == c);
+  }
+
+  int compare(StringView other) const {
+    return StringCompare::compare(storage.buffer, size, other.data(), other.length());
+  }
+
+  // Computed on every call; HashedString keeps it for keys that are hashed repeatedly.
+  uint64_t hash() const {
+    return StringHash::hash(storage.buffer, size);
   }
 
   char operator[](size_t index) const {
-    return buffer[index];
+    return storage.buffer[index];
   }
 
   char& operator[](size_t index) {
-    return buffer[index];
+    return storage.buffer[index];
   }
 
   size_t length() const {
     return size;
   }
 
+  const char* c_str() const {
+    return storage.buffer;
+  }
+
   void pop_back() {
     --size;
+    storage.buffer[size] = '\0';
   }
 
   char& front() {
-    return buffer[0];
+    return storage.buffer[0];
   }
 
   char front() const {
-    return buffer[0];
+    return storage.buffer[0];
   }
 
   void push_back(const char next_element) {
-    ++size;
-    if (size > capacity) {
-      capacity *= 2;
-      char* copy = new char[capacity];
-      memcpy(copy, buffer, size);
-      delete[] buffer;
-      buffer = copy;
+    if (size == capacity()) {
+      reallocate(grown_capacity(size + 1));
     }
-    buffer[size - 1] = next_element;
+    storage.buffer[size] = next_element;
+    storage.buffer[++size] = '\0';
   }
 
   char& back() {
-    return buffer[size - 1];
+    return storage.buffer[size - 1];
   }
 
   char back() const {
-    return buffer[size - 1];
+    return storage.buffer[size - 1];
   }
 
-  String& operator+=(const String& other) {
-    capacity = 2 * (size + other.size) + 1;
-    char* result = static_cast<char *> (malloc(capacity));
-    memcpy(result, buffer, size) ;
-    memcpy(result + size, other.buffer, other.size + 1);
-    size += other.size;
-    delete[] buffer;
-    buffer = result;
+  BasicString& operator+=(const BasicString& other) {
+    append(other.storage.buffer, other.size);
     return *this;
   }
 
-  size_t find(const String& substring, size_t begin = 0) const {
-    if (size < substring.length()) {
-      return size;
+  // data may point into this String, so the old storage.buffer is freed only after copying.
+  void append(const char* data, size_t count) {
+    if (size + count > capacity()) {
+      char* old_buffer = storage.buffer;
+      size_t old_reserved = capacity();
+      size_t new_capacity = grown_capacity(size + count);
+      char* new_buffer = acquire(new_capacity);
+      memcpy(new_buffer, old_buffer, size);
+      memcpy(new_buffer + size, data, count);
+      release(old_buffer, old_reserved);
+      adopt(new_buffer, new_capacity);
+    } else {
+      memcpy(storage.buffer + size, data, count);
     }
-    size_t sub_size = substring.length();
-    for (size_t i = begin; i <= size - sub_size; ++i) {
-      size_t current = 0;
-      while (current < sub_size && buffer[i + current] == substring[current]) {
-        ++current;
-      }
-      if (current == sub_size) {
-        return i;
-      }
+    size += count;
+    storage.buffer[size] = '\0';
+  }
+
+  // Reads up to max_count characters from buf straight into spare capacity, growing
+  // geometrically if needed; returns how many were read.
+  size_t append_from(std::streambuf* buf, size_t max_count) {
+    if (size + max_count > capacity()) {
+      reallocate(grown_capacity(size + max_count));
     }
-    return size;
+    std::streamsize read = buf->sgetn(storage.buffer + size, static_cast<std::streamsize>(max_count));
+    size += static_cast<size_t>(read);
+    storage.buffer[size] = '\0';
+    return static_cast<size_t>(read);
+  }
+
+  size_t capacity() const {
+    return is_local() ? kLocal_capacity : reserved;
   }
 
-  size_t rfind(const String& substring) const {
-    size_t ans = size;
-    size_t begin = 0;
-    while (find(substring, begin) != size) {
-      ans = find(substring, begin);
-      begin = ans + 1;
+  void reserve(size_t new_capacity) {
+    if (new_capacity > capacity()) {
+      reallocate(new_capacity);
     }
-    return ans;
   }
 
-  String substr(size_t start, size_t count) const {
-    String substring = String(count, 0);
-    for (size_t i = 0; i < count; ++i) {
-      substring.buffer[i] = buffer[start + i];
+  void shrink_to_fit() {
+    if (!is_local() && size < reserved) {
+      reallocate(size);
     }
-    return substring;
+  }
+
+  void resize(size_t new_size, char c = '\0') {
+    if (new_size > size) {
+      reserve(new_size);
+      memset(storage.buffer + size, c, new_size - size);
+    }
+    size = new_size;
+    storage.buffer[size] = '\0';
+  }
+
+  size_t find(StringView substring, size_t begin = 0) const {
+    return SubstringSearch::find(storage.buffer, size, substring.data(), substring.length(), begin);
+  }
+
+  size_t rfind(StringView substring) const {
+    return SubstringSearch::rfind(storage.buffer, size, substring.data(), substring.length());
+  }
+
+  // Single characters go straight to memchr / memrchr.
+  size_t find(char c, size_t begin = 0) const {
+    return SubstringSearch::find(storage.buffer, size, &c, 1, begin);
+  }
+
+  size_t rfind(char c) const {
+    return SubstringSearch::rfind(storage.buffer, size, &c, 1);
+  }
+
+  BasicString substr(size_t start, size_t count) const {
+    return BasicString(view(start, count), alloc());
+  }
+
+  StringView view(size_t start, size_t count) const {
+    return StringView(storage.buffer, size).substr(start, count);
+  }
+
+  operator StringView() const {
+    return StringView(storage.buffer, size);
   }
 
   bool empty() const {
@@ -131,52 +761,285 @@ public:
   }
 
   void clear() {
-    delete[] buffer;
-    buffer = new char[0];
     size = 0;
-    capacity = 1;
+    storage.buffer[0] = '\0';
+  }
+
+  BasicString& operator=(const BasicString& s) {
+    if (this != &s) {
+      BasicString copy(s, AllocTraits::propagate_on_container_copy_assignment::value ? s.alloc() : alloc());
+      exchange(copy);
+    }
+    return *this;
   }
 
-  String& operator=(const String& s) {
-    String copy = s;
-    exchange(copy);
+  BasicString& operator=(BasicString&& s) noexcept(AllocTraits::propagate_on_container_move_assignment::value) {
+    if (AllocTraits::propagate_on_container_move_assignment::value || alloc() == s.alloc()) {
+      BasicString moved = std::move(s);
+      exchange(moved);
+    } else {
+      BasicString copy(s, alloc());
+      exchange(copy);
+    }
     return *this;
   }
 
+  friend BasicString operator+(const BasicString& first, const BasicString& second) {
+    BasicString result(first);
+    result += second;
+    return result;
+  }
+
+  friend BasicString operator+(BasicString&& first, const BasicString& second) {
+    first += second;
+    return std::move(first);
+  }
+
 private:
-  void exchange(String& s) {
+  // Swaps allocators too; callers only exchange with strings whose storage may move here.
+  void exchange(BasicString& s) {
+    bool local = is_local();
+    bool other_local = s.is_local();
+    // Swapping local_buffer swaps `reserved` too, since they share storage.
+    char local_copy[kLocal_capacity + 1];
+    memcpy(local_copy, local_buffer, sizeof(local_copy));
+    memcpy(local_buffer, s.local_buffer, sizeof(local_copy));
+    memcpy(s.local_buffer, local_copy, sizeof(local_copy));
     std::swap(size, s.size);
-    std::swap(capacity, s.capacity);
-    std::swap(buffer, s.buffer);
+    std::swap(storage, s.storage);
+    if (other_local) {
+      storage.buffer = local_buffer;
+    }
+    if (local) {
+      s.storage.buffer = s.local_buffer;
+    }
   }
 
 public:
-  ~String() {
-    delete[] buffer;
+  ~BasicString() {
+    release(storage.buffer, capacity());
   };
 };
 
+using String = BasicString<>;
+
+// Immutable String that carries its hash, computed once at construction. Use it as the
+// key of hashed containers whose keys are hashed over and over (rehashing, repeated
+// lookups with the same key); having no mutable access, the hash can never go stale.
+template<typename Allocator = std::allocator<char>>
+class BasicHashedString {
+private:
+  BasicString<Allocator> string_;
+  uint64_t hash_;
+
+public:
+  explicit BasicHashedString(BasicString<Allocator> string): string_(std::move(string)), hash_(string_.hash()) {}
+
+  explicit BasicHashedString(StringView view, const Allocator& alloc = Allocator())
+      : BasicHashedString(BasicString<Allocator>(view, alloc)) {}
+
+  const BasicString<Allocator>& str() const {
+    return string_;
+  }
+
+  operator StringView() const {
+    return string_;
+  }
+
+  uint64_t hash() const {
+    return hash_;
+  }
+
+  size_t length() const {
+    return string_.length();
+  }
+
+  const char* c_str() const {
+    return string_.c_str();
+  }
+
+  bool operator==(const BasicHashedString& other) const {
+    return hash_ == other.hash_ && string_ == static_cast<StringView>(other.string_);
+  }
+
+  bool operator!=(const BasicHashedString& other) const {
+    return !(*this == other);
+  }
+};
+
+using HashedString = BasicHashedString<>;
+
+namespace std {
+template<>
+struct hash<StringView> {
+  size_t operator()(StringView view) const {
+    return static_cast<size_t>(view.hash());
+  }
+};
+
+template<typename Allocator>
+struct hash<BasicString<Allocator>> {
+  size_t operator()(const BasicString<Allocator>& string) const {
+    return static_cast<size_t>(string.hash());
+  }
+};
+
+template<typename Allocator>
+struct hash<BasicHashedString<Allocator>> {
+  size_t operator()(const BasicHashedString<Allocator>& string) const {
+    return static_cast<size_t>(string.hash());
+  }
+};
+}
+
+
+// Exposes a streambuf's protected get area, so whole runs of buffered characters
+// can be scanned and copied at once instead of going through sbumpc per char.
+class StreamBufferAccess : public std::streambuf {
+public:
+  static const char* get_begin(std::streambuf* buf) {
+    return (buf->*&StreamBufferAccess::gptr)();
+  }
+
+  static const char* get_end(std::streambuf* buf) {
+    return (buf->*&StreamBufferAccess::egptr)();
+  }
+
+  static void consume(std::streambuf* buf, size_t count) {
+    (buf->*&StreamBufferAccess::gbump)(static_cast<int>(count));
+  }
+};
+
+// Appends characters up to (not including) the first one matching `stop`.
+// Returns whether `stop` was found; the stopping character is left in the stream.
+template<typename Allocator, typename Predicate>
+bool read_until(std::streambuf* buf, BasicString<Allocator>& string, const Predicate& stop, std::ios_base::iostate& state) {
+  while (true) {
+    const char* begin = StreamBufferAccess::get_begin(buf);
+    const char* end = StreamBufferAccess::get_end(buf);
+    if (begin == end) {
+      int c = buf->sgetc();
+      if (c == std::char_traits<char>::eof()) {
+        state |= std::ios_base::eofbit;
+        return false;
+      }
+      if (StreamBufferAccess::get_begin(buf) == StreamBufferAccess::get_end(buf)) {
+        // Unbuffered stream (e.g. stdin synced with stdio): one character at a time.
+        if (stop(static_cast<char>(c))) {
+          return true;
+        }
+        string.push_back(static_cast<char>(c));
+        buf->sbumpc();
+      }
+      continue;
+    }
+    const char* current = begin;
+    while (current != end && !stop(*current)) {
+      ++current;
+    }
+    string.append(begin, current - begin);
+    StreamBufferAccess::consume(buf, current - begin);
+    if (current != end) {
+      return true;
+    }
+  }
+}
+
+template<typename Allocator>
+std::istream& operator>>(std::istream& in, BasicString<Allocator>& string) {
+  string.clear();
+  std::istream::sentry sentry(in);
+  if (!sentry) {
+    return in;
+  }
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  read_until(in.rdbuf(), string, [](char c) { return isspace(static_cast<unsigned char>(c)) != 0; }, state);
+  if (string.empty()) {
+    state |= std::ios_base::failbit;
+  }
+  in.setstate(state);
+  return in;
+}
 
-std::istream& operator>>(std::istream& in, String& string) {
+template<typename Allocator>
+std::istream& getline(std::istream& in, BasicString<Allocator>& string, char delimiter = '\n') {
   string.clear();
-  char c;
-  in.get(c);
-  while (!isspace(c) && !in.eof()) {
-    string += c;
-    in.get(c);
+  std::istream::sentry sentry(in, true);
+  if (!sentry) {
+    return in;
+  }
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  std::streambuf* buf = in.rdbuf();
+  if (read_until(buf, string, [delimiter](char c) { return c == delimiter; }, state)) {
+    buf->sbumpc();
+  } else if (string.empty()) {
+    state |= std::ios_base::failbit;
   }
+  in.setstate(state);
   return in;
 }
 
-std::ostream& operator<<(std::ostream& out, const String& string) {
-  for (size_t i = 0; i < string.length(); ++i) {
-    out << string[i];
+// Reads everything left in the stream. Seekable streams are sized up front and read
+// straight into the String; others grow it geometrically, reading into spare capacity.
+template<typename Allocator = std::allocator<char>>
+BasicString<Allocator> read_all(std::istream& in, const Allocator& alloc = Allocator()) {
+  static const size_t kChunk = 1 << 16;
+  BasicString<Allocator> result(alloc);
+  std::istream::sentry sentry(in, true);
+  if (!sentry) {
+    return result;
+  }
+  std::streambuf* buf = in.rdbuf();
+  std::streampos current = buf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+  if (current != std::streampos(-1)) {
+    std::streampos end = buf->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+    buf->pubseekpos(current, std::ios_base::in);
+    if (end != std::streampos(-1) && end > current) {
+      size_t expected = static_cast<size_t>(end - current);
+      result.reserve(expected);
+      // Reaching the known end is the common case; peek instead of probing with another chunk.
+      if (result.append_from(buf, expected) < expected ||
+          buf->sgetc() == std::char_traits<char>::eof()) {
+        in.setstate(std::ios_base::eofbit);
+        return result;
+      }
+    }
+  }
+  while (true) {
+    size_t chunk = std::max(kChunk, result.capacity() - result.length());
+    if (result.append_from(buf, chunk) < chunk) {
+      break;
+    }
   }
-  return out;
+  in.setstate(std::ios_base::eofbit);
+  return result;
+}
+
+template<typename Allocator>
+std::ostream& operator<<(std::ostream& out, const BasicString<Allocator>& string) {
+  return out << static_cast<StringView>(string);
+}
+
+// Joins Strings, C strings and chars with a single allocation sized up front.
+StringView concat_piece(StringView piece) {
+  return piece;
 }
 
-String operator+(const String& first, const String& second) {
-  String result(first);
-  result += second;
+StringView concat_piece(const char& piece) {
+  return StringView(&piece, 1);
+}
+
+template<typename... Parts>
+String concat(const Parts&... parts) {
+  StringView pieces[] = {concat_piece(parts)..., StringView()};
+  size_t total = 0;
+  for (StringView piece: pieces) {
+    total += piece.length();
+  }
+  String result;
+  result.reserve(total);
+  for (StringView piece: pieces) {
+    result.append(piece.data(), piece.length());
+  }
   return result;
-}
\ No newline at end of file
+}
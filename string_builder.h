@@ -0,0 +1,154 @@
+#pragma once
+#include <vector>
+#include "string.h"
+
+// Accumulates text in a list of fixed-size blocks, so appending never moves what
+// was already written. Inserting in the middle splits at most one block.
+// The result is materialized once, either as a String or straight into a stream.
+class StringBuilder {
+private:
+  static constexpr size_t kBlock_size = 4096;
+
+  struct Block {
+    size_t used = 0;
+    char data[kBlock_size];
+  };
+
+  std::vector<Block*> blocks;
+  size_t size = 0;
+
+  // Copies text into fresh blocks, topping up `first` beforehand if it has room.
+  std::vector<Block*> fill_blocks(Block* first, StringView text) {
+    std::vector<Block*> filled;
+    size_t copied = 0;
+    if (first != nullptr) {
+      copied = std::min(text.length(), kBlock_size - first->used);
+      memcpy(first->data + first->used, text.data(), copied);
+      first->used += copied;
+    }
+    try {
+      while (copied < text.length()) {
+        Block* block = new Block;
+        filled.push_back(block);
+        block->used = std::min(text.length() - copied, kBlock_size);
+        memcpy(block->data, text.data() + copied, block->used);
+        copied += block->used;
+      }
+    } catch (...) {
+      for (Block* block: filled) {
+        delete block;
+      }
+      throw;
+    }
+    return filled;
+  }
+
+public:
+  StringBuilder() = default;
+
+  StringBuilder(const StringBuilder&) = delete;
+
+  StringBuilder& operator=(const StringBuilder&) = delete;
+
+  StringBuilder(StringBuilder&& other) noexcept : blocks(std::move(other.blocks)), size(other.size) {
+    other.blocks.clear();
+    other.size = 0;
+  }
+
+  size_t length() const {
+    return size;
+  }
+
+  bool empty() const {
+    return size == 0;
+  }
+
+  StringBuilder& append(StringView text) {
+    std::vector<Block*> filled = fill_blocks(blocks.empty() ? nullptr : blocks.back(), text);
+    blocks.insert(blocks.end(), filled.begin(), filled.end());
+    size += text.length();
+    return *this;
+  }
+
+  StringBuilder& append(char c) {
+    return append(StringView(&c, 1));
+  }
+
+  StringBuilder& operator+=(StringView text) {
+    return append(text);
+  }
+
+  StringBuilder& operator+=(char c) {
+    return append(c);
+  }
+
+  void insert(size_t position, StringView text) {
+    if (position >= size) {
+      append(text);
+      return;
+    }
+    size_t index = 0;
+    while (position >= blocks[index]->used) {
+      position -= blocks[index]->used;
+      ++index;
+    }
+    Block* block = blocks[index];
+    if (block->used + text.length() <= kBlock_size) {
+      memmove(block->data + position + text.length(), block->data + position, block->used - position);
+      memcpy(block->data + position, text.data(), text.length());
+      block->used += text.length();
+      size += text.length();
+      return;
+    }
+    Block* tail = new Block;
+    tail->used = block->used - position;
+    memcpy(tail->data, block->data + position, tail->used);
+    size_t kept = block->used;
+    block->used = position;
+    std::vector<Block*> filled;
+    try {
+      filled = fill_blocks(block, text);
+      filled.push_back(tail);
+      blocks.insert(blocks.begin() + index + 1, filled.begin(), filled.end());
+    } catch (...) {
+      memcpy(block->data + position, tail->data, tail->used);
+      block->used = kept;
+      for (Block* added: filled) {
+        if (added != tail) {
+          delete added;
+        }
+      }
+      delete tail;
+      throw;
+    }
+    size += text.length();
+  }
+
+  void clear() {
+    for (Block* block: blocks) {
+      delete block;
+    }
+    blocks.clear();
+    size = 0;
+  }
+
+  String str() const {
+    String result;
+    result.reserve(size);
+    for (const Block* block: blocks) {
+      result.append(block->data, block->used);
+    }
+    return result;
+  }
+
+  friend std::ostream& operator<<(std::ostream& out, const StringBuilder& builder) {
+    for (const Block* block: builder.blocks) {
+      out.write(block->data, static_cast<std::streamsize>(block->used));
+    }
+    return out;
+  }
+
+  ~StringBuilder() {
+    clear();
+  }
+};
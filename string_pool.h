@@ -0,0 +1,188 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <vector>
+#include "string.h"
+
+class StringPool;
+
+// Handle to a string stored once in a StringPool. Two handles from the same pool are
+// equal exactly when their contents are, so comparing and hashing touch only the pointer.
+class InternedString {
+private:
+  struct Entry {
+    uint64_t hash;
+    size_t length;
+
+    const char* data() const {
+      return reinterpret_cast<const char*>(this + 1);
+    }
+  };
+
+  const Entry* entry = nullptr;
+
+  explicit InternedString(const Entry* entry) : entry(entry) {}
+
+  friend class StringPool;
+
+public:
+  InternedString() = default;
+
+  explicit operator bool() const {
+    return entry != nullptr;
+  }
+
+  size_t length() const {
+    return entry == nullptr ? 0 : entry->length;
+  }
+
+  const char* c_str() const {
+    return entry == nullptr ? "" : entry->data();
+  }
+
+  StringView view() const {
+    return StringView(c_str(), length());
+  }
+
+  operator StringView() const {
+    return view();
+  }
+
+  // Hash of the contents, computed once when the string was interned.
+  uint64_t content_hash() const {
+    return entry == nullptr ? 0 : entry->hash;
+  }
+
+  const void* id() const {
+    return entry;
+  }
+
+  bool operator==(const InternedString& other) const {
+    return entry == other.entry;
+  }
+
+  bool operator!=(const InternedString& other) const {
+    return entry != other.entry;
+  }
+};
+
+namespace std {
+template<>
+struct hash<InternedString> {
+  size_t operator()(const InternedString& string) const {
+    return std::hash<const void*>()(string.id());
+  }
+};
+}
+
+
+// Interning table: open addressing with linear probing over slots that cache each
+// entry's hash, so probes rarely touch character data and growing never rehashes strings.
+// Entries (header, characters, '\0') are bump-allocated from large blocks and live
+// until the pool is destroyed.
+class StringPool {
+private:
+  using Entry = InternedString::Entry;
+
+  static constexpr size_t kBlock_size = 1 << 16;
+  static constexpr size_t kInitial_slots = 64;
+
+  struct Slot {
+    uint64_t hash = 0;
+    const Entry* entry = nullptr;
+  };
+
+  std::vector<Slot> slots;
+  size_t count = 0;
+  std::vector<char*> blocks;
+  size_t block_used = kBlock_size;
+
+  size_t probe(uint64_t hash, StringView text) const {
+    size_t mask = slots.size() - 1;
+    for (size_t index = hash & mask;; index = (index + 1) & mask) {
+      const Slot& slot = slots[index];
+      if (slot.entry == nullptr || (slot.hash == hash && slot.entry->length == text.length() &&
+                                    memcmp(slot.entry->data(), text.data(), text.length()) == 0)) {
+        return index;
+      }
+    }
+  }
+
+  void grow() {
+    std::vector<Slot> old_slots(slots.empty() ? kInitial_slots : 2 * slots.size());
+    old_slots.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot: old_slots) {
+      if (slot.entry == nullptr) {
+        continue;
+      }
+      size_t index = slot.hash & mask;
+      while (slots[index].entry != nullptr) {
+        index = (index + 1) & mask;
+      }
+      slots[index] = slot;
+    }
+  }
+
+  const Entry* store(uint64_t hash, StringView text) {
+    size_t bytes = sizeof(Entry) + text.length() + 1;
+    bytes = (bytes + alignof(Entry) - 1) / alignof(Entry) * alignof(Entry);
+    char* memory;
+    if (bytes > kBlock_size / 4) {
+      // Oversized entries get their own block, kept behind the block being bumped.
+      memory = new char[bytes];
+      blocks.insert(blocks.end() - (blocks.empty() ? 0 : 1), memory);
+    } else {
+      if (block_used + bytes > kBlock_size) {
+        blocks.push_back(new char[kBlock_size]);
+        block_used = 0;
+      }
+      memory = blocks.back() + block_used;
+      block_used += bytes;
+    }
+    Entry* entry = new (memory) Entry{hash, text.length()};
+    memcpy(memory + sizeof(Entry), text.data(), text.length());
+    memory[sizeof(Entry) + text.length()] = '\0';
+    return entry;
+  }
+
+public:
+  StringPool() = default;
+
+  StringPool(const StringPool&) = delete;
+
+  StringPool& operator=(const StringPool&) = delete;
+
+  size_t size() const {
+    return count;
+  }
+
+  InternedString intern(StringView text) {
+    if (2 * (count + 1) > slots.size()) {
+      grow();
+    }
+    uint64_t hash = text.hash();
+    Slot& slot = slots[probe(hash, text)];
+    if (slot.entry == nullptr) {
+      slot.entry = store(hash, text);
+      slot.hash = hash;
+      ++count;
+    }
+    return InternedString(slot.entry);
+  }
+
+  // Looks the text up without inserting; returns an empty handle if it was never interned.
+  InternedString find(StringView text) const {
+    if (slots.empty()) {
+      return InternedString();
+    }
+    return InternedString(slots[probe(text.hash(), text)].entry);
+  }
+
+  ~StringPool() {
+    for (char* block: blocks) {
+      delete[] block;
+    }
+  }
+};